@@ -364,6 +364,15 @@ class Action: ReplaceRedirector
     /* Can this action be Undone? By default most actions can. */
     includeInUndo = true
     
+    /* 
+     *   Flag: can consecutive turns performing this action (or any other
+     *   action with collapseUndo set) share a single undo savepoint, so that
+     *   one UNDO takes them all back? This is suitable for actions like WAIT
+     *   that leave the player character's own situation unchanged. This only
+     *   has any effect if undoManager.collapseTurns is true.
+     */
+    collapseUndo = nil
+    
     /* Flag: is this a conversational action? */
     isConversational = nil
     
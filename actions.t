@@ -39,8 +39,14 @@ DefineSystemAction(Undo)
     {
         if(undo())
         {
-            DMsg(undo okay, 'One turn undone: {1}', 
-                 libGlobal.lastCommandForUndo);
+            local n = undoManager.noteUndo();
+            
+            if(n > 1)
+                DMsg(undo okay multiple, '{2} turns undone: {1}', 
+                     libGlobal.lastCommandForUndo, toString(n));
+            else
+                DMsg(undo okay, 'One turn undone: {1}', 
+                     libGlobal.lastCommandForUndo);
             
             /* notify all PostUndoObject instances */
             PostUndoObject.classExec();
@@ -617,6 +623,9 @@ DefineIAction(Wait)
     {
         DMsg(wait, 'Time {dummy} pass{es/ed}. ');
     }
+    
+    /* A run of WAITs can be undone in one step. */
+    collapseUndo = true
    
 ;
 
@@ -1628,6 +1628,32 @@ modify Actor
             boredomCount = 0;           
     }
     
+    /* 
+     *   The AgendaItems on our agenda that are currently asleep waiting for a wake-up condition
+     *   (see AgendaItem.waitTurn), or nil if there are none. For internal use only.
+     */
+    sleepingAgenda_ = nil
+    
+    /* 
+     *   When we're moved or informed of something, check whether that wakes any of our sleeping
+     *   AgendaItems.
+     */
+    moveInto(newCont)
+    {
+        inherited(newCont);
+        
+        if(sleepingAgenda_ != nil)
+            agendaWakeManager.checkActor(self);
+    }
+    
+    setInformed(tag, val?)
+    {
+        inherited(tag, val);
+        
+        if(sleepingAgenda_ != nil)
+            agendaWakeManager.checkActor(self);
+    }
+    
     
      /* 
      *   Attempt to make this actor take one step along the route currently defined on its
@@ -2274,6 +2300,21 @@ modify Actor
             curState.defaultAgendaTopic.addToAgenda(lst...);
     }
     
+    /* 
+     *   Is item on our own agenda, or on that of any DefaultAgendaTopic
+     *   directly within us or in any of our ActorStates?
+     */
+    isOnAgenda(item)
+    {
+        local onList = {mgr: mgr != nil && mgr.agendaList != nil 
+            && mgr.agendaList.indexOf(item) != nil};
+        
+        if(onList(self) || onList(defaultAgendaTopic))
+            return true;
+        
+        return allStates.indexWhich({s: onList(s.defaultAgendaTopic)}) != nil;
+    }
+    
     /*  
      *   Remove an agenda Item both from this actor and from any associated
      *   DefaultAgendaTopics directly within this actor.
@@ -5178,7 +5219,7 @@ class DefaultAgendaTopic: AgendaManager, DefaultAnyTopic
      *   to process.
      */   
     active = inherited && agendaList != nil && 
-           agendaList.indexWhich({x: x.isReady})
+           agendaList.indexWhich({x: x.readyNow()})
     
     /* 
      *   When this DefaultTopic is active we want it to take priority over over
@@ -6158,7 +6199,13 @@ actorPreinit:PreinitObject
 
 actorSchedule: Event
     eventOrder = 100
-    executeEvent() { forEachInstance(Actor, {a: a.takeTurn() }); }
+    executeEvent() 
+    { 
+        /* First wake any AgendaItems that have been waiting for this turn */
+        agendaWakeManager.wakeDue();
+        
+        forEachInstance(Actor, {a: a.takeTurn() }); 
+    }
 ;
 
 
@@ -6980,6 +7027,9 @@ modify AgendaManager
                      *   carry out any registration needed - primarily needed for FollowAgendaItems.
                      */
                     cur.registerItem();
+                    
+                    /* put the item to sleep if it's waiting for a wake-up condition */
+                    cur.checkWake();
                 }
             }
         }
@@ -7002,7 +7052,15 @@ modify AgendaManager
             {
                 foreach(local item in valToList(val))
                 {
-                    agendaList.removeElement(item);                    
+                    agendaList.removeElement(item);
+                    
+                    /* 
+                     *   If the item is asleep and no longer on any of its
+                     *   actor's agendas, the agendaWakeManager needn't keep
+                     *   track of it any more.
+                     */
+                    if(item.isAsleep && !item.getActor.isOnAgenda(item))
+                        agendaWakeManager.unregister(item);
                 }
             }
         }
@@ -7022,7 +7080,10 @@ modify AgendaManager
         if (agendaList == nil)
             return nil;
         
-        /* remove any items that are marked as done */
+        /* 
+         *   remove any items that are marked as done, including any that are asleep (see
+         *   AgendaItem.waitTurn), since they may never wake up
+         */
         while ((item = agendaList.lastValWhich({x: x.isDone})) != nil)
         {    
             actor.removeFromAllAgendas(item);
@@ -7036,7 +7097,7 @@ modify AgendaManager
          *   since that will be the ready-to-run item with the lowest
          *   agendaOrder number. 
          */
-        item = agendaList.valWhich({x: x.isReady});
+        item = agendaList.valWhich({x: x.readyNow()});
 
         /* if we found an item, execute it */
         if (item != nil)
@@ -7187,6 +7248,77 @@ class AgendaItem: object
      *   default value if you don't care about the order.  
      */
     agendaOrder = 100
+    
+    /*
+     *   Optional wake-up conditions. If any of these is non-nil and not yet met when this item is
+     *   added to an agenda, the item goes to sleep: its isReady condition isn't evaluated at all
+     *   until agendaWakeManager wakes it, which it does once all the conditions
+     *   that are defined are met. This saves polling isReady every turn on items that can't
+     *   possibly be ready, which matters in games with many actors with many agenda items.
+     *
+     *   waitTurn is the turn number (libGlobal.totalTurns) from which we can be woken.
+     *
+     *   waitLocation is a Room, Region or other container; we can be woken once our actor is in
+     *   it. This is checked when our actor is moved with moveInto(), so if our actor could arrive
+     *   there by some other means (such as being carried in a vehicle) game code should call
+     *   agendaWakeManager.checkActor(actor) at the same time.
+     *
+     *   waitFact is a fact tag; we can be woken once our actor has been informed of it.
+     *
+     *   Game code can also put an item to sleep or wake it directly by calling its sleep() and
+     *   wake() methods (from a signal handler, say).
+     */
+    waitTurn = nil
+    waitLocation = nil
+    waitFact = nil
+    
+    /* Is this item currently asleep? This should be treated as read-only. */
+    isAsleep = nil
+    
+    /* Have all our wake-up conditions been met? */
+    wakeConditionMet()
+    {
+        local actor = getActor;
+        local turn = waitTurn;
+        
+        return (turn == nil || libGlobal.totalTurns >= turn)
+            && (waitLocation == nil || actor.isIn(waitLocation))
+            && (waitFact == nil || actor.informedAbout(waitFact));
+    }
+    
+    /* 
+     *   Put this item to sleep if it has a wake-up condition that hasn't been met, or wake it up
+     *   if it's asleep and it has none. This is called when we're added to an agenda.
+     */
+    checkWake()
+    {
+        if((waitTurn != nil || waitLocation != nil || waitFact != nil) && !wakeConditionMet())
+            sleep();
+        else if(isAsleep)
+            wake();
+    }
+    
+    /* Put this item to sleep until its wake-up conditions are met or wake() is called. */
+    sleep() { agendaWakeManager.sleepItem(self); }
+    
+    /* Wake this item up. */
+    wake() { agendaWakeManager.wakeItem(self); }
+    
+    /* 
+     *   Is this item ready to execute now? This is what AgendaManager actually tests: an item
+     *   that's asleep isn't ready, and we don't evaluate its isReady condition.
+     */
+    readyNow()
+    {
+        if(isAsleep)
+        {
+            agendaWakeManager.noteSkipped();
+            return nil;
+        }
+        
+        agendaWakeManager.noteChecked();
+        return isReady;
+    }
 
     /*
      *   The caller is passed as a parameter so we can tell whether we're being
@@ -7441,10 +7573,144 @@ class DelayedAgendaItem: AgendaItem
          *   future from the current game clock time 
          */
         readyTime = libGlobal.totalTurns + turns;
+        
+        /* if we're already on an agenda, sleep (or wake) accordingly */
+        if(isAsleep)
+            checkWake();
 
         /* return 'self' for the caller's convenience */
         return self;
     }
+    
+    /* we needn't be checked at all until our ready time */
+    waitTurn = readyTime
+;
+
+/* 
+ *   The agendaWakeManager keeps track of sleeping AgendaItems (those waiting for a wake-up
+ *   condition, see AgendaItem.waitTurn) and wakes them when their conditions are met. It also
+ *   counts how many agenda items have their readiness checked or skipped, for profiling.
+ */
+agendaWakeManager: object
+    /* 
+     *   A list of [turn, item] pairs for the sleeping items waiting for a particular turn, in
+     *   ascending order of turn.
+     */
+    turnQueue = []
+    
+    /* Put item to sleep */
+    sleepItem(item)
+    {
+        local actor = item.getActor;
+        
+        /* start by removing any existing registration for item */
+        unqueue(item);
+        
+        item.isAsleep = true;
+        
+        /* add item to its actor's list of sleeping items */
+        actor.sleepingAgenda_ = valToList(actor.sleepingAgenda_).appendUnique([item]);
+        
+        /* if item is waiting for a turn, add it to our turn queue */
+        local turn = item.waitTurn;
+        if(turn != nil && turn > libGlobal.totalTurns)
+        {
+            local i = turnQueue.indexWhich({x: x[1] > turn});
+            turnQueue = (i == nil ? turnQueue + [[turn, item]]
+                         : turnQueue.insertAt(i, [turn, item]));
+        }
+    }
+    
+    /* Wake item up */
+    wakeItem(item)
+    {
+        unregister(item);
+        
+        ++wakeCount;
+    }
+    
+    /* 
+     *   Stop keeping track of item, removing it from our turn queue and from its actor's list of
+     *   sleeping items, and mark it as no longer asleep. This is called when an item is woken, or
+     *   when it's removed from the last agenda it was on.
+     */
+    unregister(item)
+    {
+        local actor = item.getActor;
+        
+        unqueue(item);
+        item.isAsleep = nil;
+        
+        if(actor.sleepingAgenda_ != nil)
+        {
+            actor.sleepingAgenda_ -= item;
+            if(actor.sleepingAgenda_.length() == 0)
+                actor.sleepingAgenda_ = nil;
+        }
+    }
+    
+    /* Remove item from our turn queue */
+    unqueue(item)
+    {
+        if(item.isAsleep)
+            turnQueue = turnQueue.subset({x: x[2] != item});
+    }
+    
+    /* 
+     *   Wake any of actor's sleeping items whose conditions have now been met. This is called when
+     *   actor is moved or informed of something.
+     */
+    checkActor(actor)
+    {
+        foreach(local item in valToList(actor.sleepingAgenda_))
+        {
+            if(item.wakeConditionMet())
+                wakeItem(item);
+        }
+    }
+    
+    /* 
+     *   Wake any items that have been waiting for the current turn, provided their other
+     *   conditions have been met. This is called at the start of each actor turn cycle, which is
+     *   also when we start our per-turn counts afresh.
+     */
+    wakeDue()
+    {
+        local turn = libGlobal.totalTurns;
+        
+        while(turnQueue.length() > 0 && turnQueue[1][1] <= turn)
+        {
+            local item = turnQueue[1][2];
+            turnQueue = turnQueue.sublist(2);
+            
+            if(item.isAsleep && item.wakeConditionMet())
+                wakeItem(item);
+        }
+        
+        lastTurnChecked = turnChecked;
+        lastTurnSkipped = turnSkipped;
+        turnChecked = 0;
+        turnSkipped = 0;
+    }
+    
+    /* Note that an awake item had its isReady condition checked. */
+    noteChecked() { ++turnChecked; ++totalChecked; }
+    
+    /* Note that a sleeping item was skipped without checking isReady. */
+    noteSkipped() { ++turnSkipped; ++totalSkipped; }
+    
+    /* 
+     *   The number of agenda items whose readiness was checked, and the number skipped because they
+     *   were asleep, so far this turn, on the previous turn, and over the whole game, together with
+     *   the number of times an item has been woken up.
+     */
+    turnChecked = 0
+    turnSkipped = 0
+    lastTurnChecked = 0
+    lastTurnSkipped = 0
+    totalChecked = 0
+    totalSkipped = 0
+    wakeCount = 0
 ;
 
 
@@ -1214,6 +1214,17 @@ CustomMessages template [messages] +priority?;
 # define IfDebug(key, code)
 #endif
 
+/*
+ *   Allocation counting.  In development builds the parser and message
+ *   code note each of their short-lived objects as they create them, so
+ *   that DEBUG ALLOCS can list how many of each were created each turn.  
+ */
+#ifdef __DEBUG
+# define NoteAlloc(cls) (allocStats.note(cls))
+#else
+# define NoteAlloc(cls)
+#endif
+
 #define gOutStream (outputManager.curOutputStream)
 
 #ifdef __DEBUG
@@ -39,6 +39,102 @@ transient browserGlobals: object
     logFileType = nil
 ;
 
+/* ------------------------------------------------------------------------ */
+/*
+ *   Web UI output batcher.  Rather than sending each fragment of main
+ *   window output to the client as soon as it's produced, we collect it
+ *   here and send it as a single update when the game next waits for
+ *   input (or when the buffer fills up), so that a typical turn costs the
+ *   client and server one update rather than dozens.
+ *   
+ *   We also keep count of the updates and bytes sent to the client, both
+ *   in total and for the last completed turn (i.e. up to the last input
+ *   request), for anyone tuning a hosted game.  
+ */
+transient webOutputBatcher: object
+    /* add text to the pending main window output */
+    write(txt)
+    {
+        if (buf_ == nil)
+            buf_ = new StringBuffer(bufferSize + 256);
+
+        buf_.append(txt);
+
+        /* if the buffer has filled up, send it now */
+        if (buf_.length() >= bufferSize)
+            flush();
+    }
+
+    /* send any pending main window output to the client */
+    flush()
+    {
+        if (buf_ != nil && buf_.length() > 0)
+        {
+            local txt = toString(buf_);
+
+            buf_.deleteChars(1);
+            commandWin.write(txt);
+            noteUpdate(txt.length());
+        }
+    }
+
+    /* 
+     *   Flush our output and note that a turn has ended, because the game
+     *   is about to wait for input. 
+     */
+    endTurn()
+    {
+        flush();
+
+        lastTurnUpdates = turnUpdates;
+        lastTurnBytes = turnBytes;
+        lastTurnSkipped = turnSkipped;
+        turnUpdates = 0;
+        turnBytes = 0;
+        turnSkipped = 0;
+    }
+
+    /* note that we've sent an update of len characters to the client */
+    noteUpdate(len)
+    {
+        turnUpdates++;
+        turnBytes += len;
+        totalUpdates++;
+        totalBytes += len;
+    }
+
+    /* note that we've skipped sending an unchanged window update */
+    noteSkipped()
+    {
+        turnSkipped++;
+        totalSkipped++;
+    }
+
+    /* 
+     *   The number of characters of output we'll hold before sending them
+     *   to the client without waiting for the end of the turn. 
+     */
+    bufferSize = 16384
+
+    /* update, byte and skipped-update counts for the current turn */
+    turnUpdates = 0
+    turnBytes = 0
+    turnSkipped = 0
+
+    /* the same counts for the last completed turn */
+    lastTurnUpdates = 0
+    lastTurnBytes = 0
+    lastTurnSkipped = 0
+
+    /* the same counts for the whole session */
+    totalUpdates = 0
+    totalBytes = 0
+    totalSkipped = 0
+
+    /* our pending output */
+    buf_ = nil
+;
+
 /* ------------------------------------------------------------------------ */
 /*
  *   Initialize the user interface.  The library calls this once at the
@@ -87,6 +183,7 @@ initDisplay()
 
     /* initialize the statusline window object */
     statuslineBanner.init();
+    statuslineBanner.resetDigest();
     statusLine.statusDispMode = StatusModeBrowser;
 
     /* set the title */
@@ -116,6 +213,7 @@ terminateUI()
     if (browserGlobals.httpServer != nil)
     {
         /* flush our windows */
+        webOutputBatcher.flush();
         webMainWin.flushWin();
         commandWin.sendWinEvent('<scrollToBottom/>');
 
@@ -162,8 +260,11 @@ checkHtmlMode()
  */
 aioSay(txt)
 {
-    /* write the text to the main command window */
-    commandWin.write(txt);
+    /* 
+     *   add the text to the pending output for the main command window,
+     *   which we'll send to the client when we next wait for input 
+     */
+    webOutputBatcher.write(txt);
 
     /* if we're logging a full transcript, write the text */
     if (browserGlobals.logFileType == LogTypeTranscript)
@@ -194,6 +295,9 @@ readingEventScript()
  */
 aioInputLineTimeout(timeout)
 {
+    /* send the client everything we've displayed this turn */
+    webOutputBatcher.endTurn();
+
     /* check for script input */
     local scriptMode = setScriptFile(ScriptReqGetStatus);
     if (scriptMode != nil)
@@ -240,6 +344,9 @@ aioInputLineCancel(reset)
  */
 aioInputEvent(timeout)
 {
+    /* send the client everything we've displayed this turn */
+    webOutputBatcher.endTurn();
+
     /* check for script input */
     if (readingEventScript())
     {
@@ -266,6 +373,9 @@ aioInputEvent(timeout)
  */
 aioMorePrompt()
 {
+    /* send the client everything we've displayed so far */
+    webOutputBatcher.flush();
+
     /* show a More prompt in the main command window */
     commandWin.showMorePrompt();
 }
@@ -276,6 +386,9 @@ aioMorePrompt()
  */
 aioClearScreen()
 {
+    /* send any pending output before clearing it away */
+    webOutputBatcher.flush();
+
     /* clear the main transcript window */
     commandWin.clearWindow();
 }
@@ -313,6 +426,7 @@ aioInputFile(prompt, dialogType, fileType, flags)
      *   current configuration, so we'll continue on to showing the dialog
      *   on the client side via the Web UI.  
      */
+    webOutputBatcher.flush();
     local f = inputFile(prompt, dialogType, fileType, flags);
 
     /* if that failed, forget the result */
@@ -397,6 +511,9 @@ aioInputFile(prompt, dialogType, fileType, flags)
  */
 aioInputDialog(icon, prompt, buttons, defaultButton, cancelButton)
 {
+    /* send the client everything we've displayed so far */
+    webOutputBatcher.flush();
+
     /* check for script input */
     local d = nil;
     if (readingEventScript())
@@ -771,6 +888,93 @@ class WebBannerWin: OutputStreamWindow
     sizeToContents() { }
 ;
 
+/*
+ *   Unchanged-update suppression for Web UI windows whose contents are
+ *   regenerated in full each time they're updated, such as the status line.
+ *   Mix this in ahead of the window's WebWindow class.  Between a
+ *   clearWindow() and the following flushWin() we hold the new contents
+ *   back, and then only send them to the client (replacing the old
+ *   contents) if their digest differs from that of the contents we last
+ *   sent.  Since the client can only be sent whole replacement contents,
+ *   this is the form our diffing takes.  
+ */
+class WebDiffWin: object
+    /* start regenerating our contents */
+    clearWindow()
+    {
+        /* if we're sending our new contents, really clear the window */
+        if (sending_)
+            inherited();
+        else
+            pending_ = new StringBuffer(256);
+    }
+
+    /* add text to our contents */
+    write(txt)
+    {
+        if (sending_)
+            inherited(txt);
+        else if (pending_ != nil)
+            pending_.append(txt);
+        else
+        {
+            inherited(txt);
+            webOutputBatcher.noteUpdate(txt.length());
+        }
+    }
+
+    /* send our new contents to the client, if they've changed */
+    flushWin()
+    {
+        if (pending_ != nil)
+        {
+            local txt = toString(pending_);
+            local digest = txt.digestMD5();
+
+            pending_ = nil;
+
+            /* if nothing's changed, there's nothing to send */
+            if (digest == lastDigest_)
+            {
+                webOutputBatcher.noteSkipped();
+                return;
+            }
+
+            /* replace our old contents with the new */
+            lastDigest_ = digest;
+            sending_ = true;
+            try
+            {
+                clearWindow();
+                write(txt);
+            }
+            finally
+            {
+                sending_ = nil;
+            }
+
+            webOutputBatcher.noteUpdate(txt.length());
+        }
+
+        inherited();
+    }
+
+    /* 
+     *   Forget what we last sent, so that our next update is sent whether
+     *   or not it has changed (e.g. after the client has been reset). 
+     */
+    resetDigest() { lastDigest_ = nil; }
+
+    /* the contents we're building, if we're regenerating them */
+    pending_ = nil
+
+    /* the digest of the contents we last sent to the client */
+    lastDigest_ = nil
+
+    /* flag: we're sending our new contents to the underlying window */
+    sending_ = nil
+;
+
 /*
  *   Output stream for web banner windows
  */
@@ -807,6 +1011,6 @@ class WebWinOutputStream: OutputStream
  *   we use iframes instead.  But we keep the name to make it easier to
  *   port games written for the traditional UI to the Web UI.  
  */
-transient statuslineBanner: WebStatusWin, WebBannerWin
+transient statuslineBanner: WebDiffWin, WebStatusWin, WebBannerWin
 ;
 
@@ -43,6 +43,8 @@ class Command: object
      */
     construct([args])
     {
+        NoteAlloc(Command);
+        
         /* presume the command will be implicitly addressed to the PC */
         actor = gPlayerChar; //World.playerChar;
 
@@ -133,6 +135,7 @@ class Command: object
     {
         /* create a new object with my same property values */
         local cl = createClone();
+        NoteAlloc(Command);
 
         /* 
          *   make a copy of the antecedent table, so that changes made in
@@ -209,10 +212,7 @@ class Command: object
             }
             
             if(action.includeInUndo && verbProd != nil)
-            {               
-                libGlobal.lastCommandForUndo = lastCommandStr;
-                savepoint();
-            }
+                undoManager.savepointFor(action, lastCommandStr);
             
          
             
@@ -1156,6 +1156,30 @@ class Command: object
             + min(tokenLen, 99);
     }
 
+    /*
+     *   Class method: calculate an upper bound on the priority that
+     *   calcPriority() can give a Command built from the parse tree 'tree',
+     *   without actually building the Command.  This lets CommandList build
+     *   and resolve Commands lazily in priority order.  calcPriority()
+     *   weights the predicate priority above everything but badMulti, so
+     *   the bound is the best score possible with the highest predicate
+     *   priority found in the tree.  If the tree contains no
+     *   VerbProduction we can't bound it, so we return nil.
+     *   
+     *   If calcPriority() is overridden to weight its components
+     *   differently, this must be overridden to match (or
+     *   CommandList.lazyBuild set to nil).  
+     */
+    priorityBound(tree)
+    {
+        local pri = tree.maxPredPriority();
+        
+        if (pri == nil)
+            return nil;
+        
+        return 250000000 + pri*2500000 + 2499999;
+    }
+
     /* 
      *   Set a fixed priority.  This makes the priority a fixed value
      *   rather than a calculated value.  We call this before sorting a
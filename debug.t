@@ -29,7 +29,7 @@ DebugCtl: object
     enabled = static (new LookupTable(32, 64))
 
     /* list of all debugging options */
-    all = ['spelling', 'messages', 'actions', 'doers']
+    all = ['spelling', 'messages', 'actions', 'doers', 'allocs']
 
     /* show the current status */
     status()
@@ -82,7 +82,7 @@ DefineSystemAction(Debug)
             else                
                 "That is not a valid option. The valid DEBUG options are DEBUG
                 MESSAGES, DEBUG SPELLING, DEBUG ACTIONS, DEBUG DOERS,
-                DEBUG OFF or DEBUG STOP (to turn off all options) or
+                DEBUG ALLOCS, DEBUG OFF or DEBUG STOP (to turn off all options) or
                 just DEBUG by itself to break into the debugger. ";
             break;
         }
@@ -850,18 +850,36 @@ class Test: object
         "====================================\n";
         "Test: \"<<testName>>\"\n";
 
-        if(restartBeforeTest) {
+        /* 
+         *   There's no need to restore the start state if nothing has changed
+         *   since we were last in it.
+         */
+        if(restartBeforeTest && !allNewTests.atStartState) {
             local hld = allNewTests.savedState();
             if(allNewTests.restoregame(&restartSaveFile) == nil) {
                 allNewTests.isTesting = nil;    // failed so quit the test
                 return;
             }
             allNewTests.restoreState(hld);
+            allNewTests.atStartState = true;
         }
 
-        /* we save the entire game at this point by default to restore it */
+        /* 
+         *   We save the entire game at this point by default to restore it,
+         *   unless we're in the start state, in which case we can just restore
+         *   the start state snapshot afterwards instead.
+         */
+        local revertProp = &revertSaveFile;
         if(restoreStartStateAfterTest)
-            allNewTests.savegame(&revertSaveFile); // save the current state
+        {
+            if(allNewTests.atStartState && allNewTests.restartSaveFile != nil)
+                revertProp = &restartSaveFile;
+            else
+                allNewTests.savegame(&revertSaveFile); // save the current state
+        }
+        
+        /* From here on the game state is about to change. */
+        allNewTests.atStartState = nil;
 
         /* 
          *   If a location is specified, first move the actor into that
@@ -947,8 +965,12 @@ class Test: object
         if(restoreStartStateAfterTest) {
 
             local hld = allNewTests.savedState();
-            allNewTests.restoregame(&revertSaveFile); // restore the saved state
+            local ok = allNewTests.restoregame(revertProp); // restore the saved state
             allNewTests.restoreState(hld);
+            
+            /* If we've just gone back to the start state, note that we're in it */
+            if(ok && revertProp == &restartSaveFile)
+                allNewTests.atStartState = true;
         }
         // this means an error happened so this script needs to go away
         if(!allNewTests.isTesting)
@@ -1061,32 +1083,7 @@ DefineSystemAction(TestAll)
             exit;
         }
 
-        allNewTests.totasserts = 0;
-        allNewTests.fasserts = 0;        
-        
-        local testenostop = cmd.verbProd.testnostop;
-        local defstop = allNewTests.stopOnFail; // what it was
-        if(testenostop)
-            allNewTests.stopOnFail = nil;
-        local cntr = 0;
-
-        foreach(local testObj in allNewTests.lst)
-        {
-            ++cntr;
-            testObj.run();
-            if(allNewTests.stopOnFail && !allNewTests.isTesting)  // Houston, we have a problem
-                break;
-            allNewTests.isTesting = nil;
-        }
-        if(testenostop)
-            allNewTests.stopOnFail = defstop;   // restore prior setting
-
-        "===========================\n";
-        "===========================\n";
-        "Total tests: \ \ \ \ \ <<cntr>>\n";
-        "Total asserts: \ \ <<allNewTests.totasserts>>\n";
-        "Failed asserts: <<allNewTests.fasserts>>\n";
-        "===========================<.p>";
+        allNewTests.runTests(allNewTests.lst, cmd.verbProd.testnostop);
     }
 ;
 
@@ -1097,6 +1094,51 @@ VerbRule(TestAll)
     verbPhrase = 'testall test scripts'
 ;
 
+/* 
+ *   The 'testshard n of m' command runs every mth test (in testOrder) starting
+ *   with the nth, so that a test harness can split a large suite between m
+ *   interpreter processes, each started with a script issuing a different
+ *   testshard command, and then combine their reports.
+ */
+DefineLiteralAction(TestShard)
+    exec(cmd)
+    {
+        local str = cmd.dobj.name.toLower.trim();
+        
+        if(rexMatch(shardPat, str) == nil)
+        {
+            DMsg(bad test shard, 'Usage: TESTSHARD n OF m ');
+            return;
+        }
+        
+        local n = toInteger(rexGroup(1)[3]);
+        local m = toInteger(rexGroup(2)[3]);
+        
+        if(n < 1 || n > m)
+        {
+            DMsg(bad test shard, 'Usage: TESTSHARD n OF m ');
+            return;
+        }
+        
+        allNewTests.runTests(allNewTests.shardList(n, m), nil, '<<n>>of<<m>>');
+    }
+    
+    shardPat = R'(<digit>+)<space>*(?:of|/)<space>*(<digit>+)$'
+    
+    /* Do nothing after the main action */
+    afterAction() { }
+      
+    turnSequence() { }
+;
+
+VerbRule(TestShard)
+    'testshard' literalDobj
+    : VerbProduction
+    action = TestShard
+    verbPhrase = 'test/testing shard (what)'
+    missingQ = 'which shard do you want to test'
+;
+
 
 ////////////////////////////////////////////////
 
@@ -1134,6 +1176,107 @@ allNewTests: object
       return lst().valWhich(cond);
    }
     
+    /* The nth of m interleaved subsets of our tests, in testOrder. */
+    shardList(n, m)
+    {
+        local vec = new Vector(lst.length / m + 1);
+        
+        for(local i = n; i <= lst.length; i += m)
+            vec.append(lst[i]);
+        
+        return vec.toList();
+    }
+    
+    /* 
+     *   Run each test in testlist, then summarize the results. If nostop is
+     *   true we carry on after a failed assertion regardless of stopOnFail.
+     *   If reportFile is defined, a line for each test giving the number of
+     *   assertions made and failed is also written to that file; label (if
+     *   supplied) is appended to the file name, so that each shard of a split
+     *   test run writes its own report.
+     */
+    runTests(testlist, nostop, label?)
+    {
+        totasserts = 0;
+        fasserts = 0;        
+        
+        local defstop = stopOnFail; // what it was
+        if(nostop)
+            stopOnFail = nil;
+        local cntr = 0;
+        local results = new Vector(testlist.length);
+
+        foreach(local testObj in testlist)
+        {
+            ++cntr;
+            local tot = totasserts, failed = fasserts;
+            testObj.run();
+            results.append([testObj.testName, totasserts - tot, 
+                           fasserts - failed]);
+            if(stopOnFail && !isTesting)  // Houston, we have a problem
+                break;
+            isTesting = nil;
+        }
+        if(nostop)
+            stopOnFail = defstop;   // restore prior setting
+
+        "===========================\n";
+        "===========================\n";
+        "Total tests: \ \ \ \ \ <<cntr>>\n";
+        "Total asserts: \ \ <<totasserts>>\n";
+        "Failed asserts: <<fasserts>>\n";
+        "===========================<.p>";
+        
+        if(reportFile != nil)
+            writeReport(results, label);
+    }
+    
+    /* 
+     *   The name of the file to which runTests() writes a machine-readable
+     *   (comma-separated) report, or nil not to write one.
+     */
+    reportFile = nil
+    
+    /* Write results, a list of [name, asserts, failed] lists, to our reportFile. */
+    writeReport(results, label)
+    {
+        local fname = reportFile;
+        
+        if(label != nil)
+        {
+            local idx = fname.findLast('.');
+            fname = idx ? fname.substr(1, idx - 1) + '-' + label + fname.substr(idx)
+                : fname + '-' + label;
+        }
+        
+        try
+        {
+            local f = File.openTextFile(fname, FileAccessWrite, 'ascii');
+            f.writeFile('test,asserts,failed\n');
+            foreach(local r in results)
+            {
+                local nam = r[1].findReplace('"', '""', ReplaceAll);
+                f.writeFile('"' + nam + '",' + r[2] + ',' + r[3] + '\n');
+            }
+            f.writeFile('TOTAL,<<totasserts>>,<<fasserts>>\n');
+            f.closeFile();
+        }
+        catch(Exception ex)
+        {
+            "<.p>### Could not write test report to <<fname>>: <<ex.getExceptionMessage()>><.p>";
+        }
+    }
+    
+    /* 
+     *   Flag: is the game known to be in the state saved in restartSaveFile?
+     *   This lets a Test that wants to restart or revert to that state skip the
+     *   save or restore when it's already there. We only set it just after
+     *   successfully restoring that snapshot, never when taking it, since the
+     *   intro and first look change the game before the first prompt; running
+     *   a test or any other command clears it.
+     */
+    atStartState = nil
+    
     isTesting = nil     // indicator to tadsSay() about copying outcome here as well
     // last message(s) to copy here; reset before each non-test cmd or after assertMsg
     lastMsg = ''
@@ -1309,6 +1452,486 @@ testInit: InitObject
    }
 ;
 
+/* 
+ *   Note that the game is no longer in its start state once any command other
+ *   than one of the test commands has been entered.
+ */
+testStatePreParser: StringPreParser
+    doParsing(str, which)
+    {
+        if(allNewTests.atStartState 
+           && rexMatch(testCmdPat, str.toLower.trim()) == nil)
+            allNewTests.atStartState = nil;
+        
+        return str;
+    }
+    
+    testCmdPat = R'(test|testall|testshard|l<space>+tests|list<space>+tests)(<space>|$)'
+;
+
+/* ------------------------------------------------------------------------ */
+/*
+ *   Soak testing.  The SOAK n command plays n pseudo-random commands without
+ *   further input, discarding their output, and every soakTest.sampleInterval
+ *   commands writes a line of statistics to soakTest.csvFile, so that a game
+ *   author can look for memory leaks (Vectors, Events or other objects that
+ *   keep piling up) and for any fall-off in the rate at which turns are
+ *   processed over a run of many thousands of turns.  SOAK n SEED s uses
+ *   s to seed the random number generator; the same seed in the same game
+ *   state always plays the same commands.
+ */
+DefineLiteralAction(Soak)
+    exec(cmd)
+    {
+        local str = cmd.dobj.name.toLower.trim();
+        
+        if(rexMatch(soakPat, str) == nil)
+        {
+            DMsg(bad soak, 'Usage: SOAK n [SEED s] ');
+            return;
+        }
+        
+        local n = toInteger(rexGroup(1)[3]);
+        local seed = rexGroup(2) ? toInteger(rexGroup(2)[3]) : soakTest.seed;
+        
+        soakTest.run(n, seed);
+    }
+    
+    soakPat = R'(<digit>+)(?:<space>+seed<space>+(<digit>+))?$'
+    
+    /* Do nothing after the main action */
+    afterAction() { }
+      
+    turnSequence() { }
+;
+
+VerbRule(Soak)
+    'soak' literalDobj
+    : VerbProduction
+    action = Soak
+    verbPhrase = 'soak/soaking (what)'
+    missingQ = 'how many turns do you want to soak test'
+;
+
+/* 
+ *   The soakTest object chooses and plays the commands for the SOAK command
+ *   and records its statistics.
+ */
+soakTest: object
+    /* The file to which we write our statistics, as comma-separated values. */
+    csvFile = 'soak.csv'
+    
+    /* The number of commands to play between each line of statistics. */
+    sampleInterval = 1000
+    
+    /* The random number seed to use if SOAK isn't given one. */
+    seed = 1
+    
+    /* The percentage of commands to which we add the name of an object in scope. */
+    objPercent = 75
+    
+    /* 
+     *   Actions whose verbs we never use. We also leave out all SystemActions,
+     *   since these would save, restore, undo or end the game.
+     */
+    excludeActions = [GTest, TestShard, Soak]
+    
+    /* Flag: are we in the middle of a soak test? */
+    running = nil
+    
+    /* Flag: has the game ended during the current soak test? */
+    gameOver = nil
+    
+    /* 
+     *   Play n commands chosen using the random number seed seed, writing
+     *   statistics to our csvFile as we go.
+     */
+    run(n, seed)
+    {
+        local verbs = verbWords();
+        local f;
+        
+        try
+        {
+            f = File.openTextFile(csvFile, FileAccessWrite, 'ascii');
+        }
+        catch(Exception ex)
+        {
+            "<.p>### Could not open <<csvFile>>: <<ex.getExceptionMessage()>><.p>";
+            return;
+        }
+        
+        f.writeFile('turn,gameTurns,elapsedMs,turnsPerSec,objects,vectors,'
+                    + 'lookupTables,events,savepoints,stateBytes,outputChars\n');
+        
+        randomize(RNG_ISAAC, seed);
+        
+        local counter = new SoakOutputCounter();
+        local temp = new TemporaryFile();
+        local start = getTime(GetTimeTicks), last = start, lastTurn = 0;
+        local i;
+        
+        writeSample(f, 0, 0, 0, 0, temp);
+        
+        running = true;
+        gameOver = nil;
+        mainOutputStream.addOutputFilter(counter);
+        
+        try
+        {
+            for(i = 1; i <= n && !gameOver; ++i)
+            {
+                playTurn(nextCommand(verbs));
+                
+                if(i % sampleInterval == 0 || i == n || gameOver)
+                {
+                    local now = getTime(GetTimeTicks);
+                    local rate = (now > last ? ((i - lastTurn) * 1000) / (now - last) : 0);
+                    
+                    writeSample(f, i, now - start, rate, counter.chars, temp);
+                    
+                    /* don't count the time taken to sample against the next interval */
+                    last = getTime(GetTimeTicks);
+                    lastTurn = i;
+                }
+            }
+        }
+        finally
+        {
+            mainOutputStream.removeOutputFilter(counter);
+            running = nil;
+            f.closeFile();
+            temp.deleteFile();
+        }
+        
+        "<.p>Soak test: <<i - 1>> commands in <<getTime(GetTimeTicks) - start>> ms
+        (seed <<seed>>); statistics written to <<csvFile>>.<.p>";
+        
+        if(gameOver)
+            "<.p>### The game ended during the soak test.<.p>";
+    }
+    
+    /* 
+     *   Play one command, as mainCommandLoop() would have done if the player
+     *   had typed txt.
+     */
+    playTurn(txt)
+    {
+        /* Display score notifications if the score module is included. */
+        if(defined(scoreNotifier) && scoreNotifier.checkNotification())
+            ;
+        
+        /* run any PromptDaemons if the events module is included */
+        if(defined(eventManager) && eventManager.executePrompt())
+            ;
+        
+        try
+        {
+            /* Pass the command through all our StringPreParsers */
+            txt = StringPreParser.runAll(txt, Parser.rmcType());
+            
+            /* Parse and execute the command. */
+            if(txt != nil)
+                Parser.parse(txt);
+        }
+        catch(TerminateCommandException tce)
+        {
+        }
+        catch(SoakGameOverSignal sig)
+        {
+        }
+        
+        /* Update the status line. */
+        statusLine.showStatusLine();
+    }
+    
+    /* 
+     *   The verbs we can use in our commands, taken from the spelling
+     *   corrector's table of the words in each action's grammar, in sorted
+     *   order so that a given seed always picks the same verbs.
+     */
+    verbWords()
+    {
+        local tab = actionDictionary.getWordToAction();
+        local vec = new Vector(tab.getEntryCount());
+        
+        tab.forEachAssoc(new function(w, acts) {
+            if(acts.indexWhich({a: a.ofKind(SystemAction) 
+                               || excludeActions.indexOf(a) != nil}) == nil)
+                vec.append(w);
+        });
+        
+        return vec.toList().sort(SortAsc);
+    }
+    
+    /* 
+     *   Choose a command: one of verbs, usually followed by the name of
+     *   something in the player character's scope.
+     */
+    nextCommand(verbs)
+    {
+        local txt = verbs[rand(verbs.length) + 1];
+        
+        if(rand(100) < objPercent)
+        {
+            local objs = Q.scopeList(gPlayerChar).toList().subset(
+                {o: o.ofKind(Thing) && o.name not in (nil, '')});
+            
+            if(objs.length > 0)
+                txt += ' ' + objs[rand(objs.length) + 1].name;
+        }
+        
+        return txt;
+    }
+    
+    /* 
+     *   Write a line of statistics to f. We can't measure the size of the
+     *   interpreter's undo log, so besides the number of savepoints created we
+     *   give the size of the game state as saved to temp.
+     */
+    writeSample(f, turn, elapsed, rate, chars, temp)
+    {
+        /* collect garbage first so that we only count live objects */
+        t3RunGC();
+        
+        f.writeFile('<<turn>>,<<libGlobal.totalTurns>>,<<elapsed>>,<<rate>>,'
+                    + '<<countInstances(nil)>>,<<countInstances(Vector)>>,'
+                    + '<<countInstances(LookupTable)>>,'
+                    + '<<defined(eventManager) ? eventManager.eventList.length : 0>>,'
+                    + '<<undoManager.savepointCount>>,<<stateSize(temp)>>,<<chars>>\n');
+    }
+    
+    /* The number of instances of cls, or of all objects if cls is nil. */
+    countInstances(cls)
+    {
+        local n = 0;
+        
+        if(cls == nil)
+        {
+            for(local o = firstObj(ObjInstances); o != nil; o = nextObj(o, ObjInstances))
+                ++n;
+        }
+        else
+        {
+            for(local o = firstObj(cls, ObjInstances); o != nil; 
+                o = nextObj(o, cls, ObjInstances))
+                ++n;
+        }
+        
+        return n;
+    }
+    
+    /* The size in bytes of the game state when saved to temp. */
+    stateSize(temp)
+    {
+        saveGame(temp);
+        
+        local f = File.openRawFile(temp, FileAccessRead);
+        local sz = f.getFileSize();
+        f.closeFile();
+        
+        return sz;
+    }
+;
+
+/* An output filter that counts and discards the output of a soak test. */
+class SoakOutputCounter: CaptureFilter
+    filterText(ostr, txt)
+    {
+        if(txt != nil)
+            chars += txt.length();
+        
+        return inherited(ostr, txt);
+    }
+    
+    /* The number of characters of output we've discarded */
+    chars = 0
+;
+
+/* 
+ *   Thrown when the game ends during a soak test, so that we can stop the soak
+ *   test instead of waiting for the player to choose what to do next.
+ */
+class SoakGameOverSignal: Exception
+;
+
+/* ------------------------------------------------------------------------ */
+/*
+ *   Startup profiler.  In a debug build all the PreinitObjects as well as
+ *   the InitObjects run every time the game starts, which can make for a
+ *   noticeable delay before the first prompt in a large game.  We time each
+ *   one as it runs, and if showAtStartup is true we list the timings at the
+ *   first prompt so the game author can see where the time goes.
+ */
+modify ModuleExecObject
+    _execute()
+    {
+        /* only time objects running for the first time during startup */
+        if (!startupProfiler.active || hasInitialized_)
+            return inherited();
+        
+        startupProfiler.enter(self);
+        try
+        {
+            return inherited();
+        }
+        finally
+        {
+            startupProfiler.leave(self);
+        }
+    }
+;
+
+transient startupProfiler: object
+    /* Flag: do we want to list the startup timings at the first prompt? */
+    showAtStartup = nil
+    
+    /* Are we still recording timings? */
+    active = true
+    
+    /* 
+     *   The objects we've timed, in the order they finished, and a table
+     *   mapping each one to a [total, self] pair of times in milliseconds.
+     *   The total time includes that of any objects the object had run
+     *   first (through its execBeforeMe list); the self time excludes it.
+     */
+    order_ = static new Vector(64)
+    times_ = static new LookupTable(64, 128)
+    
+    /* The start times and child times of the objects currently running */
+    startStack_ = static new Vector(8)
+    childStack_ = static new Vector(8)
+    
+    /* Note that obj is starting to run */
+    enter(obj)
+    {
+        startStack_.append(getTime(GetTimeTicks));
+        childStack_.append(0);
+    }
+    
+    /* Note that obj has finished running */
+    leave(obj)
+    {
+        local total = getTime(GetTimeTicks) - startStack_.pop();
+        local child = childStack_.pop();
+        
+        /* charge our total time to whatever was running us */
+        local len = childStack_.length();
+        if (len > 0)
+            childStack_[len] += total;
+        
+        order_.append(obj);
+        times_[obj] = [total, total - child];
+    }
+    
+    /* Stop recording, and list the timings if we want to. */
+    finish()
+    {
+        active = nil;
+        
+        if (showAtStartup)
+            report();
+    }
+    
+    /* List the timings of everything that took any time at all */
+    report()
+    {
+        local lst = order_.toList().subset({o: times_[o][1] > 0 });
+        local tot = 0;
+        
+        lst = lst.sort(SortDesc, {a, b: times_[a][2] - times_[b][2]});
+        
+        "<.p>Startup timings (ms, self/total):\n";
+        foreach (local obj in lst)
+        {
+            local t = times_[obj];
+            "\t<<t[2]>>/<<t[1]>>\t<<valToSym(obj)>>\n";
+            tot += t[2];
+        }
+        "Total: <<tot>> ms<.p>";
+    }
+;
+
+/* Stop recording startup timings at the first prompt. */
+startupProfilerInit: InitObject
+    execute()
+    {
+        if(defined(OneTimePromptDaemon)
+           && new OneTimePromptDaemon(startupProfiler, &finish));
+    }
+;
+
+
+/* ------------------------------------------------------------------------ */
+/*
+ *   Allocation statistics.  The parser, the scope and message code call
+ *   NoteAlloc() each time they create one of their short-lived objects
+ *   (NPMatch, NounPhrase, Command, ScopeList, SpellingHistory, MessageCtx),
+ *   and we count them by class.  With DEBUG ALLOCS on, we list the counts for
+ *   each turn before the next prompt.
+ */
+transient allocStats: object
+    /* Note the creation of an object of class cls */
+    note(cls)
+    {
+        if(turn_ == nil)
+            reset();
+        
+        turn_[cls] = (turn_[cls] ?? 0) + 1;
+        total_[cls] = (total_[cls] ?? 0) + 1;
+    }
+    
+    /* Note the end of a turn, listing its counts if DEBUG ALLOCS is on */
+    endTurn()
+    {
+        if(turn_ == nil)
+            return;
+        
+        ++turns;
+        
+        IfDebug(allocs, report());
+        
+        /* start the next turn's counts from zero */
+        foreach(local cls in turn_.keysToList())
+            turn_[cls] = 0;
+    }
+    
+    /* List this turn's counts, and the average per turn so far */
+    report()
+    {
+        local lst = total_.keysToList().sort(SortAsc, 
+            {a, b: valToSym(a).compareTo(valToSym(b))});
+        
+        "<.p>[Allocations this turn (average over <<turns>> turns):";
+        foreach(local cls in lst)
+            " <<valToSym(cls)>> <<turn_[cls]>> (<<total_[cls] / turns>>);";
+        " ScopeList buffers from pool <<scopeListPool.hits>>/<<scopeListPool.hits
+            + scopeListPool.misses>>]<.p>";
+    }
+    
+    /* Start counting from scratch */
+    reset()
+    {
+        turn_ = new transient LookupTable(16, 32);
+        total_ = new transient LookupTable(16, 32);
+        turns = 0;
+    }
+    
+    /* The number of turns we've counted */
+    turns = 0
+    
+    /* Tables of the counts for the current turn and in total, by class */
+    turn_ = nil
+    total_ = nil
+;
+
+/* Close each turn's allocation statistics before the next prompt */
+allocStatsInit: InitObject
+    execute()
+    {
+        if(defined(PromptDaemon) && new PromptDaemon(allocStats, &endTurn));
+    }
+;
 
 
 #endif // __DEBUG
@@ -570,8 +570,39 @@ class LMentionable: object
 
         /* inherit any vocab from our superclasses */
         inheritVocab();
-                
-        /* clear our vocabulary word list */
+        
+        /* 
+         *   Get the parsed form of our vocab string. Many objects (such as
+         *   Decorations and the instances of a common class) share exactly
+         *   the same vocab, so we parse each distinct vocab string only
+         *   once, and the objects that share it share the resulting list of
+         *   VocabWords too.
+         */
+        local vp = vocabParseCache.find(vocab);
+        
+        if(vp == nil)
+            vp = vocabParseCache.store(vocab, parseVocab(vocab));
+        
+        /* Apply the results of the parse to this object */
+        applyVocab(vp);
+    }
+    
+    /* 
+     *   Parse the vocab string str, returning a VocabParse object describing
+     *   the results. This adds the words to the dictionary, but otherwise
+     *   leaves it to applyVocab() to apply the results to this (or any other)
+     *   object.
+     */
+    parseVocab(str)
+    {
+        local vp = new transient VocabParse();
+        
+        /* 
+         *   initVocabWord() builds our vocabWords and pluralTokens, so give
+         *   it fresh ones to work on and collect the results at the end.
+         */
+        local oldPluralTokens = pluralTokens;
+        pluralTokens = nil;
         vocabWords = new Vector(10);
 
         
@@ -581,35 +612,24 @@ class LMentionable: object
          *   (tok) into tok[weak], so that they're effectively treated
          *   as prepositions (i.e. they won't match alone)
          */
-        local str = vocab.findReplace(R'<lparen>.*?<rparen>', 
+        str = str.findReplace(R'<lparen>.*?<rparen>', 
                                       {s: s.substr(2, s.length - 2) +
                                       (s == '()' ? '()' : '[weak]')});
 
         /* pull out the major parts, delimited by semicolons */
         local parts = str.split(';').mapAll({x: x.trim()});
         
-        
- #ifdef __DEBUG
-
-        if(parts.length > 4)
-        {
-            "<b><FONT COLOR=RED>WARNING!</b></FONT> ";
-            "Too many semicolons in vocab string '<<vocab>>'; there should be a
-            maximum of three separating four different sections.\n";
-        }
- #endif
+#ifdef __DEBUG
+        /* keep the sections so that applyVocab() can check them */
+        vp.sections = parts;
+#endif
 
         /* the first part is the short name */
         local shortName = parts[1].trim();
  
 
-        /* 
-         *   if the short name is all in title case, and 'proper' isn't
-         *   explicitly set or we're repacing vocab, mark it as a proper name 
-         */
-        if ((propDefined(&proper, PropDefGetClass) == Mentionable || replacingVocab)
-            && rexMatch(properNamePat, shortName) != nil)
-            proper = true;
+        /* note whether the short name is all in title case */
+        vp.properName = (rexMatch(properNamePat, shortName) != nil);
 
         /* note the tentative name value */
         local tentativeName = shortName;
@@ -621,6 +641,9 @@ class LMentionable: object
         local i = 1;
         if (wlen > 0 && wlst[1] is in('a', 'an', 'some', 'the', '()'))
         {
+            /* note the article for applyVocab() */
+            vp.article = wlst[1];
+            
             /* check which word we have */
             switch (wlst[1])
             {
@@ -633,19 +656,8 @@ class LMentionable: object
                 if (wlen > 1 && aNameFrom(wlst[2]) != '<<wlst[1]>> <<wlst[2]>>')
                     specialAOrAn[wlst[2]] = (wlst[1] == 'a' ? 1 : 2);
                 break;
-                
-            case 'some':
-                /* mark this as a mass noun */
-                massNoun = true;
-                break;
-                
-            case '()':            
-                /* mark this as a qualified name */
-                qualified = true;
-                break;               
             
             case 'the':
-                qualified = true;
                 wlst[1] = '!!!&&&';
                 break;
             }
@@ -659,12 +671,12 @@ class LMentionable: object
         }
 
         /* 
-         *   If there's no 'name' property already, assign the name from
-         *   the short name string.  Remove any of the special annotations
-         *   for parts of speech or plural forms. 
+         *   Note the name to use if the object doesn't already have one,
+         *   removing any of the special annotations for parts of speech or
+         *   plural forms.
          */
-        if (name == nil && tentativeName != '')
-            name = tentativeName.findReplace(deannotatePat, '', ReplaceAll);
+        if (tentativeName != '')
+            vp.name = tentativeName.findReplace(deannotatePat, '', ReplaceAll);
 
         /* 
          *   Process each word in the short name.  Assume each is an
@@ -744,27 +756,6 @@ class LMentionable: object
             parts[2].split(' ').forEach(
                 {x: initVocabWord(x.trim(), MatchAdj)});
             
-#ifdef __DEBUG
-            /* 
-             *   If we're compiling for debugging, issue a warning if a pronoun
-             *   appears in the adjective section. We exclude 'her' from the
-             *   list of pronouns we test for here since 'her' in the adjective
-             *   section could be intended as the female possessive pronoun. But
-             *   only carry out this check for a Thing, since a Topic might
-             *   legally have pronouns in any section.
-             */
-            parts[2].split(' ').forEach(function(x){
-                if(ofKind(Thing) && x is in ('him', 'it', 'them', 'them!'))
-                {
-                    "<b><FONT COLOR=RED>WARNING!</FONT></B> ";
-                    "Pronoun '<<x>>' appears in adjective section (after first
-                    semicolon) of vocab string '<<vocab>>'. This may mean the
-                    vocab string has too few semicolons.\n";
-                }
-                
-            });
-#endif
-            
         }
 
 
@@ -773,93 +764,139 @@ class LMentionable: object
         {            
             parts[3].split(' ').forEach(
                 {x: initVocabWord(x.trim(), MatchNoun)});
+        }
+
+
             
+        /* the fourth section is the list of pronouns */
+        if (parts.length() >= 4)
+            vp.pronouns = parts[4];
+        
+        /* collect the results and restore our own plural tokens */
+        vp.words = vocabWords.toList();
+        vp.pluralTokens = valToList(pluralTokens);
+        pluralTokens = oldPluralTokens;
+        
+        return vp;
+    }
+    
+    /* 
+     *   Apply the results of parsing a vocab string (the VocabParse object
+     *   vp) to this object.
+     */
+    applyVocab(vp)
+    {
 #ifdef __DEBUG
-            /* 
-             *   If we're compiling for debugging, issue a warning if a pronoun
-             *   appears in the noun section.
-             */
-            parts[3].split(' ').forEach(function(x){
-                if(ofKind(Thing) && x is in ('him', 'her', 'it', 'them', 'them!'))
-                {
-                    "<b><FONT COLOR=RED>WARNING!</FONT></B> ";
-                    "Pronoun '<<x>>' appears in noun section (after second
-                    semicolon) of vocab string '<<vocab>>'. This probably
-                    mean this vocab string has too few semicolons.\n";
-                }
-                
-            });
+        /* 
+         *   Check the sections of the vocab string for likely mistakes. We do
+         *   this here rather than in parseVocab() so that the warnings are
+         *   given for every object they apply to, not just the first object
+         *   to use the vocab string.
+         */
+        checkVocabSections(vp.sections);
 #endif
+        
+        /* 
+         *   if the short name is all in title case, and 'proper' isn't
+         *   explicitly set or we're repacing vocab, mark it as a proper name 
+         */
+        if ((propDefined(&proper, PropDefGetClass) == Mentionable || replacingVocab)
+            && vp.properName)
+            proper = true;
+        
+        /* check for an article at the start of the name */
+        switch (vp.article)
+        {
+        case 'some':
+            /* mark this as a mass noun */
+            massNoun = true;
+            break;
+            
+        case '()':
+        case 'the':
+            /* mark this as a qualified name */
+            qualified = true;
+            break;
         }
-
-
+        
+        /* If there's no 'name' property already, assign the parsed name */
+        if (name == nil && vp.name != nil)
+            name = vp.name;
+        
+        /* 
+         *   Take our vocabWords from the parse; this list is shared with any
+         *   other objects with the same vocab, but since lists are immutable
+         *   anything that changes our vocabWords later will simply give us a
+         *   new list of our own.
+         */
+        vocabWords = vp.words;
+        
+        /* add any plural tokens marked with [pn] */
+        if (vp.pluralTokens.length() > 0)
+            pluralTokens = valToList(pluralTokens).appendUnique(vp.pluralTokens);
+        
+        local pron = vp.pronouns;
+        
+        /* the fourth section is the list of pronouns */
+        if (pron != '')
+        {
+            local map = ['it', &isIt,
+                'him', &isHim,
+                'her', &isHer,
+                'them', &plural,
+                'them!', &isGenderNeutral ];
             
-            /* the fourth section is the list of pronouns */
-            if (parts.length() >= 4 && parts[4] != '')
-            {
-                local map = ['it', &isIt,
-                    'him', &isHim,
-                    'her', &isHer,
-                    'them', &plural,
-                    'them!', &isGenderNeutral ];
+            local explicitlySingular = nil;
+            
+                           
+            pron.split(' ').forEach(function(x) {
                 
-                local explicitlySingular = nil;
+                local i = map.indexOf(x.trim());
+                if (i != nil)
+                    self.(map[i+1]) = true;
                 
-                               
-                parts[4].split(' ').forEach(function(x) {
-                    
-                    local i = map.indexOf(x.trim());
-                    if (i != nil)
-                        self.(map[i+1]) = true;
-                    
-                    if(x.trim() != 'them')                    
-                        explicitlySingular = true;     
-                                          
-                });
+                if(x.trim() != 'them')                    
+                    explicitlySingular = true;     
+                                      
+            });
+            
+            /* 
+             *   If we're both explicitly singular and plural (i.e. both a
+             *   singular pronoun and 'them' have appeared in our pronoun
+             *   list) we must be ambiguously plural.
+             */
+            
+            if(explicitlySingular && plural)
+            {
+                ambiguouslyPlural = true;
                 
                 /* 
-                 *   If we're both explicitly singular and plural (i.e. both a
-                 *   singular pronoun and 'them' have appeared in our pronoun
-                 *   list) we must be ambiguously plural.
+                 *   We're actually plural only if 'them' is the first
+                 *   pronoun encountered; so if it's not we're actually
+                 *   singular.
                  */
                 
-                if(explicitlySingular && plural)
-                {
-                    ambiguouslyPlural = true;
-                    
-                    /* 
-                     *   We're actually plural only if 'them' is the first
-                     *   pronoun encountered; so if it's not we're actually
-                     *   singular.
-                     */
-                    
-                    if(!parts[4].trim().startsWith('them'))
-                        plural = nil;
-                    
-                }
-#ifdef __DEBUG
-            /* 
-             *   If we're compiling for debugging, issue a warning if a
-             *   something other than a pronoun appears in the pronoun section.
-             */
-            parts[4].split(' ').forEach(function(x){
-                if(x not in ('him', 'her', 'it', 'them', 'them!'))
-                {
-                    "<b><FONT COLOR=RED>WARNING!</FONT></B> ";
-                    "Non-Pronoun '<<x>>' appears in pronoun section (after third
-                    semicolon) of vocab string '<<vocab>>'. Check that this
-                    vocab string doesn't have too many semicolons.\n";
-                }
+                if(!pron.trim().startsWith('them'))
+                    plural = nil;
                 
-            });
-#endif
             }
-
-
-        
-        
-        /* turn vocabWords back into a list */
-        vocabWords = vocabWords.toList();
+#ifdef __DEBUG
+        /* 
+         *   If we're compiling for debugging, issue a warning if a
+         *   something other than a pronoun appears in the pronoun section.
+         */
+        pron.split(' ').forEach(function(x){
+            if(x not in ('him', 'her', 'it', 'them', 'them!'))
+            {
+                "<b><FONT COLOR=RED>WARNING!</FONT></B> ";
+                "Non-Pronoun '<<x>>' appears in pronoun section (after third
+                semicolon) of vocab string '<<vocab>>'. Check that this
+                vocab string doesn't have too many semicolons.\n";
+            }
+            
+        });
+#endif
+        }
     }
 
     /* 
@@ -887,7 +924,86 @@ class LMentionable: object
         if(vocab == nil || vocab == '')            
             return;
         
+        /* 
+         *   If we've already inherited our vocab, and it hasn't been changed
+         *   since, there's nothing more to do. This saves classes from
+         *   repeating (and so duplicating) the work for every instance that
+         *   inherits from them.
+         */
+        if(propDefined(&inheritedVocab_, PropDefDirectly)
+           && inheritedVocab_ == vocab)
+            return;
+        
+        /* Carry out the inheritance and note the result */
+        inheritSuperclassVocab();        
+        inheritedVocab_ = vocab;
+    }
+    
+    /* 
+     *   The vocab we (as a class or object) ended up with the last time we
+     *   carried out inheritVocab(); for internal use only.
+     */
+    inheritedVocab_ = nil
+    
+#ifdef __DEBUG
+    /* 
+     *   Issue warnings about any likely mistakes in parts, the list of
+     *   sections of our vocab string.
+     */
+    checkVocabSections(parts)
+    {
+        if(parts.length > 4)
+        {
+            "<b><FONT COLOR=RED>WARNING!</b></FONT> ";
+            "Too many semicolons in vocab string '<<vocab>>'; there should be a
+            maximum of three separating four different sections.\n";
+        }
+        
+        /* 
+         *   Issue a warning if a pronoun appears in the adjective section. We
+         *   exclude 'her' from the list of pronouns we test for here since
+         *   'her' in the adjective section could be intended as the female
+         *   possessive pronoun. But only carry out this check (and the next)
+         *   for a Thing, since a Topic might legally have pronouns in any
+         *   section.
+         */
+        if(parts.length() >= 2 && parts[2] != '' && ofKind(Thing))
+        {
+            parts[2].split(' ').forEach(function(x){
+                if(x is in ('him', 'it', 'them', 'them!'))
+                {
+                    "<b><FONT COLOR=RED>WARNING!</FONT></B> ";
+                    "Pronoun '<<x>>' appears in adjective section (after first
+                    semicolon) of vocab string '<<vocab>>'. This may mean the
+                    vocab string has too few semicolons.\n";
+                }
+                
+            });
+        }
         
+        /* Issue a warning if a pronoun appears in the noun section. */
+        if(parts.length() >= 3 && parts[3] != '' && ofKind(Thing))
+        {
+            parts[3].split(' ').forEach(function(x){
+                if(x is in ('him', 'her', 'it', 'them', 'them!'))
+                {
+                    "<b><FONT COLOR=RED>WARNING!</FONT></B> ";
+                    "Pronoun '<<x>>' appears in noun section (after second
+                    semicolon) of vocab string '<<vocab>>'. This probably
+                    mean this vocab string has too few semicolons.\n";
+                }
+                
+            });
+        }
+    }
+#endif
+    
+    /* 
+     *   Carry out the vocab inheritance for inheritVocab(); this is for
+     *   internal use only.
+     */
+    inheritSuperclassVocab()
+    {
         foreach(local cls in getSuperclassList)
         {   
             /* 
@@ -1952,6 +2068,84 @@ class LMentionable: object
     } 
 ;
 
+/* 
+ *   A VocabParse holds the result of parsing a vocab string with
+ *   LMentionable.parseVocab(), in a form that applyVocab() can apply to any
+ *   object with that vocab string.
+ */
+class VocabParse: object
+    /* the name given by the vocab string, or nil if it doesn't give one */
+    name = nil
+    
+    /* is the short name in title case (suggesting a proper name)? */
+    properName = nil
+    
+    /* the article ('a', 'an', 'some', 'the' or '()') the name starts with */
+    article = nil
+    
+    /* the list of VocabWords */
+    words = []
+    
+    /* the list of words marked as plural tokens with [pn] */
+    pluralTokens = []
+    
+    /* the pronoun section of the vocab string */
+    pronouns = ''
+    
+    /* the list of sections of the vocab string (only kept in debug builds) */
+    sections = []
+;
+
+/* 
+ *   The vocabParseCache holds the parsed form of the distinct vocab strings
+ *   we've seen most recently, so that each is normally parsed only once
+ *   however many objects share it. This is transient and bounded, like the
+ *   countedPluralCache, so that it neither keeps the strings of objects
+ *   created during play alive nor adds to saved games.
+ */
+transient vocabParseCache: object
+    /* Get the VocabParse for str, or nil if we don't have it */
+    find(str)
+    {
+        local vp = (tab_ == nil ? nil : tab_[str]);
+        
+        if(vp != nil)
+            hits++;
+        else
+            misses++;
+        
+        return vp;
+    }
+    
+    /* Remember that vp is the parsed form of str, and return vp */
+    store(str, vp)
+    {
+        /* 
+         *   Start a new table if we haven't got one, or if the current one
+         *   has grown too large.
+         */
+        if(tab_ == nil || tab_.getEntryCount() >= maxEntries)
+            tab_ = new transient LookupTable(256, 512);
+        
+        tab_[str] = vp;
+        
+        return vp;
+    }
+    
+    /* The most vocab strings we remember before starting again. */
+    maxEntries = 2000
+    
+    /* Table of vocab strings -> VocabParse objects */
+    tab_ = nil
+    
+    /* 
+     *   The number of times we've found a vocab string already parsed, and
+     *   the number of times we've had to parse one.
+     */
+    hits = 0
+    misses = 0
+;
+
 
 modify SubComponent
     /* 
@@ -3825,25 +4019,31 @@ genList(lst, conj)
  */     
 mergeDuplicates(lst)
 {
-    /* A vector to store items that have duplicates */
-    local dupVec = new Vector(10);
+    /* 
+     *   Count how many times each item occurs in the list, in a single pass
+     *   (rather than counting the whole list again for each item, which
+     *   would make listing a long run of identical items quadratic).
+     */
+    local counts = new LookupTable(16, 32);
+    foreach(local cur in lst)
+        counts[cur] = (counts[cur] ?? 0) + 1;
     
     /* The Vector we build to return the processed list */
-    local processedVec = new Vector(10);
+    local processedVec = new Vector(counts.getEntryCount());
     
     /* Go through every item in our list */
     foreach(local cur in lst)
     {
+        /*   Get the number of times the current item occurs in the list */
+        local num = counts[cur];
+        
         /* 
          *   If we've already dealt with this item (or one identical to it),
          *   skip over it.
          */
-        if(dupVec.indexOf(cur))
+        if(num == nil)
             continue;
         
-        /*   Count how many times the current item occurs in the list */
-        local num = lst.countWhich({x: x == cur});
-        
         /*   
          *   If it doesn't occur more than once, simply add it to the processed
          *   list and continue to the next item.
@@ -3865,15 +4065,15 @@ mergeDuplicates(lst)
             /* 
              *   If the makeCountedPlural() function returned the current value
              *   unchanged simply add it to the processed list, otherwise add
-             *   the plural form to the processed list and the current form to
-             *   the list of duplicated items.
+             *   the plural form to the processed list and remove the current
+             *   form from our table, so that we skip its other occurrences.
              */
             if(pl == cur)
                 processedVec.append(cur);
             else
             {
                 processedVec.append(pl);
-                dupVec.append(cur);                    
+                counts.removeElement(cur);
             }
         }
         
@@ -3892,6 +4092,24 @@ mergeDuplicates(lst)
  *   if there is one.
  */
 makeCountedPlural(str, num)
+{
+    /* 
+     *   Listing the same group of items again (as each INVENTORY or LOOK
+     *   will) gives the same result, so see if we've already worked it out.
+     */
+    local pl = countedPluralCache.find(str, num);
+    
+    if(pl == nil)
+        pl = countedPluralCache.store(str, num, makeCountedPluralFrom(str, num));
+    
+    return pl;
+}
+
+/* 
+ *   Work out the counted plural for makeCountedPlural(), which caches the
+ *   result.
+ */
+makeCountedPluralFrom(str, num)
 {
     /* Split the string into a list of words to make it easier to manipulate */
     local strList = str.split(' ');
@@ -3928,6 +4146,59 @@ makeCountedPlural(str, num)
     return LMentionable.pluralNameFrom(strList.join(' '));
 }
 
+/* 
+ *   The countedPluralCache remembers the last counted plural that
+ *   makeCountedPlural() worked out for each name. It's transient, since
+ *   there's no need to save it or undo changes to it.
+ */
+transient countedPluralCache: object
+    /* 
+     *   Get the counted plural of str for num items, or nil if we don't
+     *   have it.
+     */
+    find(str, num)
+    {
+        local ent = (tab_ == nil ? nil : tab_[str]);
+        
+        if(ent != nil && ent[1] == num)
+        {
+            hits++;
+            return ent[2];
+        }
+        
+        misses++;
+        return nil;
+    }
+    
+    /* Remember that pl is the counted plural of str for num items, and return pl */
+    store(str, num, pl)
+    {
+        /* 
+         *   Start a new table if we haven't got one, or if the current one
+         *   has grown too large.
+         */
+        if(tab_ == nil || tab_.getEntryCount() >= maxEntries)
+            tab_ = new transient LookupTable(64, 128);
+        
+        tab_[str] = [num, pl];
+        
+        return pl;
+    }
+    
+    /* The most names we remember before starting again. */
+    maxEntries = 500
+    
+    /* Table of name -> [number, counted plural] */
+    tab_ = nil
+    
+    /* 
+     *   The number of times we've found a counted plural already worked out,
+     *   and the number of times we've had to work one out.
+     */
+    hits = 0
+    misses = 0
+;
+
 /* 
  *   Remove any definite or indefinite article that occurs at the beginning of
  *   txt, and return the resultant string in lower case.
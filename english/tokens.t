@@ -195,6 +195,80 @@ cmdTokenizer: Tokenizer
     /* token-separating punctuation marks, as an <alpha|x|y> pattern */
     punctChars = '.|,|;|:|?|!'
 
+    /*
+     *   Tokenize a string.  Most commands consist of nothing but plain
+     *   ASCII words, numbers, spaces and the odd separating punctuation
+     *   mark, and for these the outcome of the rule list above is entirely
+     *   predictable: each run of letters and digits is a word (or an
+     *   integer, if it's all digits), and each punctuation mark is a
+     *   punctuation token.  For such strings we can therefore skip the
+     *   rule-by-rule regular expression matching and build the token list
+     *   directly.  Anything else (including a word followed immediately by
+     *   a period, which might be an abbreviation or a set of initials) goes
+     *   through the full rule list as before.
+     */
+    tokenize(str)
+    {
+        if (useFastPath
+            && rexMatch(fastPathPat, str) == str.length()
+            && rexSearch(fastPathAbbrPat, str) == nil)
+        {
+            ++fastCount;
+            return fastTokenize(str);
+        }
+
+        ++ruleCount;
+        return inherited(str);
+    }
+
+    /*
+     *   Tokenize a string consisting only of the characters matched by
+     *   fastPathPat, producing exactly the same tokens as the rule list
+     *   would.
+     */
+    fastTokenize(str)
+    {
+        local toks = new Vector(16);
+        local idx = 1;
+        local m;
+
+        while ((m = rexSearch(fastTokPat, str, idx)) != nil)
+        {
+            local txt = m[3];
+            local typ;
+
+            if (rexMatch(fastPunctPat, txt) != nil)
+                typ = tokPunct;
+            else if (rexMatch(fastIntPat, txt) != nil)
+                typ = tokInt;
+            else
+                typ = tokWord;
+
+            toks.append([txt, typ, txt]);
+            idx = m[1] + m[2];
+        }
+
+        return toks.toList();
+    }
+
+    /* flag: do we use the fast path for plain ASCII input? */
+    useFastPath = true
+
+    /* the number of strings tokenized by the fast path and by the rules */
+    fastCount = 0
+    ruleCount = 0
+
+    /* a string the fast path can handle */
+    fastPathPat = static new RexPattern('[a-zA-Z0-9 .,;:?!]*')
+
+    /* a word or number immediately followed by a period */
+    fastPathAbbrPat = static new RexPattern('[a-zA-Z0-9]<period>')
+
+    /* a single fast-path token, and tests for its type */
+    fastTokPat = static new RexPattern('[a-zA-Z0-9]+|[.,;:?!]')
+    fastPunctPat = static new RexPattern('[.,;:?!]$')
+    fastIntPat = static new RexPattern('[0-9]+$')
+
     /* end-of-token assertion */
     endAssert = static ('(?=$|<space|' + punctChars + '>)')
 
@@ -312,14 +386,14 @@ cmdTokenizer: Tokenizer
     {
         local str;
 
-        /* start with an empty string */
-        str = '';
+        /* start with an empty buffer */
+        str = new StringBuffer(toks.length() * 8);
 
         /* concatenate each token in the list */
         for (local i = 1, local len = toks.length() ; i <= len ; ++i)
         {
             /* add the current token to the string */
-            str += getTokOrig(toks[i]);
+            str.append(getTokOrig(toks[i]));
 
             /*
              *   if this looks like a hyphenated number that we picked
@@ -327,8 +401,8 @@ cmdTokenizer: Tokenizer
              *   spaces
              */
             if (i + 2 <= len
-                && rexMatch(patSpelledTens, getTokVal(toks[i])) != nil
                 && getTokVal(toks[i+1]) == '-'
+                && rexMatch(patSpelledTens, getTokVal(toks[i])) != nil
                 && rexMatch(patSpelledUnits, getTokVal(toks[i+2])) != nil)
             {
                 /*
@@ -336,7 +410,8 @@ cmdTokenizer: Tokenizer
                  *   tokens back together without any intervening spaces,
                  *   so ['twenty', '-', 'one'] turns into 'twenty-one'
                  */
-                str += getTokOrig(toks[i+1]) + getTokOrig(toks[i+2]);
+                str.append(getTokOrig(toks[i+1]));
+                str.append(getTokOrig(toks[i+2]));
 
                 /* skip ahead by the two extra tokens we're adding */
                 i += 2;
@@ -349,7 +424,7 @@ cmdTokenizer: Tokenizer
                  *   it's a word followed by an apostrophe-s token - these
                  *   are appended together without any intervening spaces
                  */
-                str += getTokOrig(toks[i+1]);
+                str.append(getTokOrig(toks[i+1]));
 
                 /* skip the extra token we added */
                 ++i;
@@ -360,11 +435,11 @@ cmdTokenizer: Tokenizer
              *   punctuation mark, add a space before the next token
              */
             if (i < len && rexMatch(patPunct, getTokVal(toks[i+1])) == nil)
-                str += ' ';
+                str.append(' ');
         }
 
         /* return the result string */
-        return str;
+        return toString(str);
     }
 
     /* some pre-compiled regular expressions */
@@ -184,6 +184,7 @@ exitLister: PreinitObject
         /* set the new status */
         exitsMode.inStatusLine = stat;
         exitsMode.inRoomDesc = look;
+        libGlobal.exitsChanged();
 
         /* confirm the new status */
         DMsg(exits on off okay, 'Okay. Exit listing in the status line is now 
@@ -205,16 +206,56 @@ exitLister: PreinitObject
         showExitsFrom(actor, actor.getOutermostRoom);
     }
 
-    /* show an exit list display in the status line, if desired */
+    /* 
+     *   Show an exit list display in the status line, if desired. The status
+     *   line may be redrawn several times without anything relevant having
+     *   changed, so we keep the last rendered exit list in
+     *   statuslineExitsCache and simply redisplay it if the player
+     *   character's room, its lighting and libGlobal.exitsVersion (and, if
+     *   refreshExitsEachTurn is true, the turn count) are all as they were
+     *   when we rendered it.
+     */
     showStatuslineExits()
     {
-        /* if statusline exit displays are enabled, show the exit list */
-        if (exitsMode.inStatusLine)
-            showExitsWithLister(gPlayerChar, gPlayerChar.getOutermostRoom,
-                                statuslineExitLister,
-                                gPlayerChar.location
-                                .wouldBeLitFor(gPlayerChar));
+        /* if statusline exit displays are not enabled, there's nothing to do */
+        if (!exitsMode.inStatusLine)
+            return;
+        
+        local loc = gPlayerChar.getOutermostRoom;
+        local lit = gPlayerChar.location.wouldBeLitFor(gPlayerChar);
+        local cache = statuslineExitsCache;
+        
+        if(cache.isValidFor(loc, lit))
+        {
+            ++cache.hits;
+            say(cache.txt);
+            return;
+        }
+        
+        /* render the exit list afresh, capturing the result */
+        local txt = gOutStream.captureOutput(
+            {: showExitsWithLister(gPlayerChar, loc, statuslineExitLister, 
+                                   lit) });
+        
+        cache.store(loc, lit, txt);
+        ++cache.misses;
+        
+        say(txt);
     }
+    
+    /* 
+     *   Flag: do we want the status line exit list to be recomputed at least
+     *   once every turn? By default we do, since the list can depend on
+     *   things the library doesn't monitor, such as a direction property
+     *   being changed, a door being moved, whether a destination has been
+     *   visited, or a custom isConnectorVisible or canTravelerPass method. A
+     *   game that calls libGlobal.exitsChanged() whenever any such thing
+     *   changes can set this to nil, so that the list is only recomputed
+     *   when the player character changes room, the lighting changes, or
+     *   exitsChanged() is called (as the library does when a door is opened
+     *   or closed, for example).
+     */
+    refreshExitsEachTurn = true
 
     /* 
      *   Calculate the contribution of the exits list to the height of the
@@ -342,6 +383,54 @@ exitLister: PreinitObject
 ;
 
 
+/* 
+ *   The cached rendering of the status line exit list, together with the
+ *   stamps it was computed against. This is transient since it's purely a
+ *   display cache; it's discarded after UNDO or RESTORE in any case.
+ */
+transient statuslineExitsCache: PostRestoreObject, PostUndoObject
+    /* The room, lighting and stamps the cached text was rendered for */
+    loc = nil
+    lit = nil
+    turn = nil
+    version = nil
+    
+    /* The cached rendering */
+    txt = nil
+    
+    /* Counts of reused and recomputed exit lists, for diagnostic purposes */
+    hits = 0
+    misses = 0
+    
+    /* Can we reuse our cached text for loc when its lighting is lit? */
+    isValidFor(loc_, lit_)
+    {
+        return txt != nil && loc == loc_ && lit == lit_
+            && version == libGlobal.exitsVersion
+            && (!gExitLister.refreshExitsEachTurn
+                || turn == libGlobal.totalTurns);
+    }
+    
+    /* Store a freshly rendered exit list */
+    store(loc_, lit_, txt_)
+    {
+        loc = loc_;
+        lit = lit_;
+        turn = libGlobal.totalTurns;
+        version = libGlobal.exitsVersion;
+        txt = txt_;
+    }
+    
+    /* Discard the cached text */
+    clear() { txt = nil; }
+    
+    /* 
+     *   After UNDO or RESTORE the stamps may coincide with those of a
+     *   different game state, so start afresh.
+     */
+    execute() { clear(); }
+;
+
 ExitLister: Lister
     showListAll(lst, options, indent)
     {
@@ -620,6 +709,7 @@ exitsMode: object
             /* pull out the two variables from the regexp groups */
             inStatusLine = (rexGroup(1)[3] == 'on');
             inRoomDesc = (rexGroup(2)[3] == 'on');
+            libGlobal.exitsChanged();
         }
     }
 
@@ -0,0 +1,745 @@
+#charset "us-ascii"
+#include "advlite.h"
+
+/*
+ *   DELTASAVE EXTENSION
+ *
+ *   Incremental checkpointing for adv3Lite games.
+ *
+ *   A full saveGame() writes out the entire heap, which on a large game can
+ *   take long enough to be noticeable if it's done every few turns (as an
+ *   autosave feature might want to do). This extension instead writes a
+ *   full VM snapshot (the "base") only occasionally, and in between appends
+ *   small "delta" records to a companion text file recording just those
+ *   tracked properties that have changed since the last checkpoint.
+ *
+ *   To restore, call deltaSave.restoreLatest(), which restores the base
+ *   snapshot with restoreGame() and then replays every complete delta record
+ *   on top of it. A record is only applied once its terminating line has
+ *   been read, so a checkpoint interrupted half-way through is simply
+ *   ignored.
+ *
+ *   Only the properties listed in deltaSave.trackedProps on objects matching
+ *   deltaSave.trackedClasses (or listed in deltaSave.extraTracked) are
+ *   compared and journalled; the base snapshot remains the authority for
+ *   everything else. Whenever a changed value can't be expressed in the
+ *   delta format (because, say, it refers to an object created since the
+ *   last base) the extension simply writes a fresh base instead, as it also
+ *   does after UNDO, RESTORE or RESTART, and whenever the delta file has
+ *   grown past maxDeltas records or maxDeltaSize characters.
+ *
+ *   The ordinary SAVE and RESTORE commands are unaffected by this extension;
+ *   games wanting periodic autosaves should set deltaSave.interval to the
+ *   number of turns between checkpoints.
+ */
+
+/* Every object's id in the delta file (see deltaSaveIds) [DELTASAVE EXTENSION] */
+property deltaSaveId_;
+
+/*
+ *   The deltaSaveData object holds the tables of enum and property names we
+ *   need to encode delta records.
+ *   [DELTASAVE EXTENSION]
+ */
+deltaSaveData: PreinitObject
+    /*
+     *   Tables of enum and property names, built at preinit (the only time
+     *   the global symbol table is reliably available), so that we can
+     *   write enums and property pointers to the delta file by name.
+     */
+    enumNames = nil
+    enumVals = nil
+    propNames = nil
+    propVals = nil
+
+    execute()
+    {
+        enumNames = new LookupTable(64, 128);
+        enumVals = new LookupTable(64, 128);
+        propNames = new LookupTable(256, 512);
+        propVals = new LookupTable(256, 512);
+
+        t3GetGlobalSymbols().forEachAssoc(new function(key, value)
+        {
+            switch(dataType(value))
+            {
+            case TypeEnum:
+                enumNames[value] = key;
+                enumVals[key] = value;
+                break;
+            case TypeProp:
+                propNames[value] = key;
+                propVals[key] = value;
+                break;
+            default:
+                break;
+            }
+        });
+    }
+
+;
+
+/*
+ *   The deltaSaveIds object numbers the objects in the game, so that delta
+ *   records can refer to them. Each object's number is stored in its own
+ *   deltaSaveId_ property, so that it's saved as part of the base snapshot,
+ *   while the table for looking objects up is transient, refers to them only
+ *   weakly, and is rebuilt from those properties after the base is restored.
+ *   So we never keep an object alive just because it's been numbered, and
+ *   saved games don't have to include a list of every object in the game.
+ *   [DELTASAVE EXTENSION]
+ */
+transient deltaSaveIds: object
+    /*
+     *   A WeakRefLookupTable mapping the ids we've assigned for the current
+     *   base to their objects.
+     */
+    idTab = nil
+
+    /* The last id we assigned */
+    maxId = 0
+
+    /* A Vector of the ids of those objects whose properties we track */
+    trackList = nil
+
+    /*
+     *   Number every TadsObject currently on the heap and note which of them
+     *   have tracked properties. This is called immediately before writing a
+     *   new base, so that the numbering is saved as part of it.
+     */
+    build()
+    {
+        idTab = new transient WeakRefLookupTable(1024, 4096);
+        trackList = new Vector(1024);
+        maxId = 0;
+
+        for(local obj = firstObj(TadsObject, ObjAll); obj != nil;
+            obj = nextObj(obj, TadsObject, ObjAll))
+        {
+            obj.deltaSaveId_ = ++maxId;
+            idTab[maxId] = obj;
+
+            if(deltaSave.isTracked(obj))
+                trackList.append(maxId);
+        }
+    }
+
+    /*
+     *   Rebuild our tables from the ids stored on the objects, after the base
+     *   has been restored.
+     */
+    rebuild()
+    {
+        idTab = new transient WeakRefLookupTable(1024, 4096);
+        trackList = new Vector(1024);
+        maxId = 0;
+
+        for(local obj = firstObj(TadsObject, ObjAll); obj != nil;
+            obj = nextObj(obj, TadsObject, ObjAll))
+        {
+            if(!obj.propDefined(&deltaSaveId_, PropDefDirectly))
+                continue;
+
+            local id = obj.deltaSaveId_;
+
+            idTab[id] = obj;
+            if(id > maxId)
+                maxId = id;
+        }
+
+        for(local id = 1; id <= maxId; id++)
+        {
+            local obj = idTab[id];
+
+            if(obj != nil && deltaSave.isTracked(obj))
+                trackList.append(id);
+        }
+    }
+
+    /*
+     *   Get the id of obj, or nil if it hasn't got one for the current base
+     *   (because it was created since, for example). An id only counts if obj
+     *   defines it directly, since otherwise it may simply have inherited its
+     *   class's id, and if it's really obj's, since createClone() copies it.
+     */
+    idOf(obj)
+    {
+        if(idTab == nil || !obj.propDefined(&deltaSaveId_, PropDefDirectly))
+            return nil;
+
+        local id = obj.deltaSaveId_;
+
+        return idTab[id] == obj ? id : nil;
+    }
+
+    /*
+     *   Get the object whose id is id, or nil if it's been garbage-collected
+     *   since we numbered it.
+     */
+    objFor(id) { return idTab[id]; }
+;
+
+/*
+ *   The deltaSave object is the interface to this extension; it's transient
+ *   since its bookkeeping describes the files on disk, not the game state.
+ *   [DELTASAVE EXTENSION]
+ */
+transient deltaSave: object
+    /* The file holding the base snapshot */
+    baseFile = 'autosave.t3v'
+
+    /* The file to which delta records are appended */
+    deltaFile = 'autosave.dlt'
+
+    /*
+     *   The number of turns between automatic checkpoints. If this is 0 (the
+     *   default) no automatic checkpoints are made, and it's up to game code
+     *   to call checkpoint() when it wants one.
+     */
+    interval = 0
+
+    /*
+     *   The maximum number of delta records (and the maximum total size of
+     *   delta records, in characters) we'll append before compacting them
+     *   into a new base snapshot.
+     */
+    maxDeltas = 50
+    maxDeltaSize = 262144
+
+    /*
+     *   The classes whose instances have their trackedProps journalled. Games
+     *   can add their own classes here.
+     */
+    trackedClasses = [Thing, Event, AgendaItem,
+        defined(Scene) ? Scene : nil,
+        defined(Relation) ? Relation : nil]
+
+    /*
+     *   Individual objects, not of any of the trackedClasses, whose
+     *   trackedProps should also be journalled.
+     */
+    extraTracked = [libGlobal, eventManager]
+
+    /*
+     *   The properties we journal. These are the properties the library
+     *   itself changes during play; games should append any of their own
+     *   properties that change during play and matter for a restore.
+     */
+    trackedProps = [&location, &contents, &seen, &familiar, &examined,
+        &isOpen, &isLocked, &isLit, &isOn, &wornBy, &moved, &isHidden,
+        &informedNameTab, &curState, &agendaList, &isDone,
+        &isHappening, &startedAt, &endedAt, &timesHappened, &howEnded,
+        &nextRunTime, &executed, &eventList, &totalTurns, &relTab]
+
+    /* Is obj one whose properties we track? */
+    isTracked(obj)
+    {
+        return extraTracked.indexOf(obj) != nil
+            || trackedClasses.indexWhich({c: c != nil && obj.ofKind(c)}) != nil;
+    }
+
+    /*
+     *   Flag: do we need to write a fresh base before we can write any more
+     *   deltas? This starts out true, and is set again after any UNDO,
+     *   RESTORE or RESTART, since then our shadow copy no longer describes
+     *   the state the delta file was built on.
+     */
+    baseNeeded = true
+
+    /*
+     *   A table of the tracked property values as they stood at the last
+     *   checkpoint, keyed on (object id, property index).
+     */
+    shadowTab = nil
+
+    /* The number of records and characters in the current delta file */
+    deltaCount = 0
+    deltaSize = 0
+
+    /* The turn on which we last made a checkpoint */
+    lastCheckpointTurn = 0
+
+    /* Counters, for anyone tuning maxDeltas and maxDeltaSize */
+    baseCount = 0
+    checkpointCount = 0
+
+    /*
+     *   Record the current state of the game, either by appending a delta
+     *   record or, if need be, by writing a new base. Returns true on
+     *   success or nil if the files couldn't be written.
+     */
+    checkpoint()
+    {
+        local changes;
+
+        lastCheckpointTurn = libGlobal.totalTurns;
+        checkpointCount++;
+
+        if(baseNeeded || deltaCount >= maxDeltas || deltaSize >= maxDeltaSize)
+            return writeBase();
+
+        /*
+         *   Find out what's changed; if anything changed to a value we can't
+         *   encode, fall back to writing a base.
+         */
+        changes = scan(true);
+        if(changes == nil)
+            return writeBase();
+
+        if(changes.length == 0)
+            return true;
+
+        try
+        {
+            local f = File.openTextFile(deltaFile, FileAccessReadWriteKeep,
+                                        'utf-8');
+            local len = 0;
+
+            f.setPosEnd();
+            f.writeFile('T <<libGlobal.totalTurns>>\n');
+
+            foreach(local c in changes)
+            {
+                local line = '<<c[1]>> <<c[2]>> <<c[3]>>\n';
+                f.writeFile(line);
+                len += line.length;
+            }
+
+            /* The terminating line marks the record as complete */
+            f.writeFile('E\n');
+            f.closeFile();
+
+            deltaCount++;
+            deltaSize += len;
+        }
+        catch(FileException fe)
+        {
+            /*
+             *   The shadow copy now describes state that isn't on disk, so
+             *   make sure the next checkpoint starts afresh.
+             */
+            baseNeeded = true;
+            return nil;
+        }
+
+        return true;
+    }
+
+    /*
+     *   Write a full snapshot of the game as the new base, and start a fresh
+     *   delta file to go with it.
+     */
+    writeBase()
+    {
+        try
+        {
+            deltaSaveIds.build();
+            saveGame(baseFile);
+
+            local f = File.openTextFile(deltaFile, FileAccessWrite, 'utf-8');
+            f.writeFile('DELTASAVE 1\n');
+            f.closeFile();
+        }
+        catch(RuntimeError err)
+        {
+            baseNeeded = true;
+            return nil;
+        }
+        catch(FileException fe)
+        {
+            baseNeeded = true;
+            return nil;
+        }
+
+        scan(nil);
+        baseNeeded = nil;
+        deltaCount = 0;
+        deltaSize = 0;
+        baseCount++;
+        return true;
+    }
+
+    /*
+     *   Restore the game from the base snapshot and the delta records
+     *   following it. Returns true on success or nil if there was no base to
+     *   restore; any other failure of restoreGame() is passed on to the
+     *   caller as the usual RuntimeError.
+     */
+    restoreLatest()
+    {
+        local pending = new Vector(64);
+        local f, line, count = 0;
+
+        if(!fileExists(baseFile))
+            return nil;
+
+        restoreGame(baseFile);
+
+        /* Find the objects the delta records refer to */
+        deltaSaveIds.rebuild();
+
+        try
+        {
+            f = File.openTextFile(deltaFile, FileAccessRead, 'utf-8');
+
+            while((line = f.readFile()) != nil)
+            {
+                if(line.endsWith('\n'))
+                    line = line.substr(1, line.length - 1);
+
+                if(line.startsWith('T '))
+                    pending.setLength(0);
+                else if(line == 'E')
+                {
+                    foreach(local p in pending)
+                        applyLine(p);
+
+                    pending.setLength(0);
+                    count++;
+                }
+                else if(!line.startsWith('DELTASAVE'))
+                    pending.append(line);
+            }
+
+            f.closeFile();
+        }
+        catch(FileException fe)
+        {
+            /* No delta file just means there's nothing to replay */
+        }
+
+        /*
+         *   The caches derived from the properties we've just replayed (which
+         *   were saved along with the base) no longer match them, so discard
+         *   or rebuild them.
+         */
+        resetCaches();
+
+        /*
+         *   Let everything else that caches derived state rebuild it, just as
+         *   it would after any other restore.
+         */
+        PostRestoreObject.restoreCode = 3;
+        PostRestoreObject.classExec();
+
+        /*
+         *   The game now matches what's on disk, so we can carry on appending
+         *   to the same delta file.
+         */
+        scan(nil);
+        baseNeeded = nil;
+        deltaCount = count;
+        deltaSize = 0;
+        lastCheckpointTurn = libGlobal.totalTurns;
+        return true;
+    }
+
+    /*
+     *   Discard or rebuild the library caches derived from our tracked
+     *   properties, after replaying delta records has changed them behind
+     *   the library's back. Region membership (and so each Room's regionTab)
+     *   depends only on properties we don't track, and the status line exit
+     *   cache is discarded by its own PostRestoreObject, but we also bump
+     *   libGlobal.exitsVersion since doors may have been opened or moved.
+     */
+    resetCaches()
+    {
+        /* The aggregates cached on Things depend on their contents */
+        forEachInstance(Thing, {t: t.aggregateStamp = nil});
+
+        libGlobal.exitsChanged();
+
+        /* The SENSORY extension's index of emanations by room */
+        if(defined(emanationControl))
+            emanationControl.indexDirty = true;
+
+        /* The factManager's table of who knows each fact */
+        if(defined(factManager))
+            factManager.rebuildKnowers();
+    }
+
+    /* Is there a file named fname we can read? */
+    fileExists(fname)
+    {
+        try
+        {
+            File.openRawFile(fname, FileAccessRead).closeFile();
+            return true;
+        }
+        catch(FileException fe)
+        {
+            return nil;
+        }
+    }
+
+    /* Apply one 'id propIndex value' line of a delta record */
+    applyLine(line)
+    {
+        local i = line.find(' ');
+        local j = line.find(' ', i + 1);
+        local obj = deltaSaveIds.objFor(toInteger(line.substr(1, i - 1)));
+        local prop = trackedProps[toInteger(line.substr(i + 1, j - i - 1))];
+
+        /* skip anything that's been garbage-collected */
+        if(obj != nil)
+            obj.(prop) = decodeAt(line, j + 1)[1];
+    }
+
+    /*
+     *   Compare the current values of the tracked properties with our shadow
+     *   copy, bringing the shadow up to date as we go. If report is true,
+     *   return a list of [id, propIndex, encodedValue] triplets describing
+     *   the changes, or nil if any changed value can't be encoded; otherwise
+     *   just rebuild the shadow and return nil.
+     */
+    scan(report)
+    {
+        local nprops = trackedProps.length;
+        local changes = new Vector(32);
+
+        if(!report || shadowTab == nil)
+            shadowTab = new LookupTable(1024, 8192);
+
+        foreach(local id in deltaSaveIds.trackList)
+        {
+            local obj = deltaSaveIds.objFor(id);
+
+            /* skip anything that's been garbage-collected */
+            if(obj == nil)
+                continue;
+
+            for(local pi = 1; pi <= nprops; pi++)
+            {
+                local prop = trackedProps[pi];
+                local key = id * (nprops + 1) + pi;
+                local val, cur;
+
+                if(!obj.propDefined(prop))
+                    continue;
+
+                switch(obj.propType(prop))
+                {
+                case TypeCode:
+                case TypeNativeCode:
+                    continue;
+                default:
+                    break;
+                }
+
+                val = obj.(prop);
+
+                /*
+                 *   Collections can change without the property itself
+                 *   changing, so for those we compare encodings; anything else
+                 *   can be compared directly.
+                 */
+                if(isCollection(val))
+                {
+                    cur = encode(val);
+
+                    /*
+                     *   If we can't encode the collection, we can't tell
+                     *   whether it's changed, so we can only record the game
+                     *   by writing a base. In the shadow we note it with
+                     *   true (which can't be an encoding) rather than nil,
+                     *   which would match a nil value.
+                     */
+                    if(cur == nil)
+                    {
+                        if(report)
+                            return nil;
+
+                        cur = true;
+                    }
+                }
+                else
+                    cur = val;
+
+                if(report && shadowTab[key] != cur)
+                {
+                    local enc = isCollection(val) ? cur : encode(val);
+
+                    if(enc == nil)
+                        return nil;
+
+                    changes.append([id, pi, enc]);
+                }
+
+                shadowTab[key] = cur;
+            }
+        }
+
+        return report ? changes : nil;
+    }
+
+    /* Is val a Vector or LookupTable? */
+    isCollection(val)
+    {
+        return dataType(val) == TypeObject
+            && (val.ofKind(Vector) || val.ofKind(LookupTable));
+    }
+
+    /*
+     *   Encode val as a self-delimiting string, or return nil if it's not
+     *   something we can represent.
+     */
+    encode(val)
+    {
+        local name;
+
+        switch(dataType(val))
+        {
+        case TypeNil:
+            return 'n';
+        case TypeTrue:
+            return 't';
+        case TypeInt:
+            return 'i<<val>>;';
+        case TypeSString:
+            val = val.findReplace('\\', '\\\\', ReplaceAll)
+                .findReplace('\n', '\\n', ReplaceAll);
+            return 's<<val.length>>:' + val;
+        case TypeEnum:
+            name = deltaSaveData.enumNames[val];
+            return name == nil ? nil : 'e' + name + ';';
+        case TypeProp:
+            name = deltaSaveData.propNames[val];
+            return name == nil ? nil : 'p' + name + ';';
+        case TypeList:
+            return encodeSeq('l', val);
+        case TypeObject:
+            if(val.ofKind(Vector))
+                return encodeSeq('v', val.toList());
+
+            if(val.ofKind(LookupTable))
+            {
+                local elems = [];
+                val.forEachAssoc({k, v: elems += [k, v]});
+                return encodeSeq('h', elems);
+            }
+
+            name = deltaSaveIds.idOf(val);
+            return name == nil ? nil : 'o<<name>>;';
+        default:
+            return nil;
+        }
+    }
+
+    /* Encode a list of values with the given type prefix */
+    encodeSeq(prefix, lst)
+    {
+        local buf = new StringBuffer(lst.length * 8);
+
+        buf.append(prefix + lst.length + ':');
+
+        foreach(local elem in lst)
+        {
+            local enc = encode(elem);
+            if(enc == nil)
+                return nil;
+
+            buf.append(enc);
+        }
+
+        return toString(buf);
+    }
+
+    /*
+     *   Decode the value encoded at position i of str, returning a list of
+     *   the value and the position just after its encoding.
+     */
+    decodeAt(str, i)
+    {
+        local c = str.substr(i, 1);
+        local j, n, vec, tab;
+
+        if(c == 'n')
+            return [nil, i + 1];
+
+        if(c == 't')
+            return [true, i + 1];
+
+        if(c is in ('i', 'o', 'e', 'p'))
+        {
+            local tok;
+
+            j = str.find(';', i);
+            tok = str.substr(i + 1, j - i - 1);
+
+            switch(c)
+            {
+            case 'i':
+                return [toInteger(tok), j + 1];
+            case 'o':
+                return [deltaSaveIds.objFor(toInteger(tok)), j + 1];
+            case 'e':
+                return [deltaSaveData.enumVals[tok], j + 1];
+            default:
+                return [deltaSaveData.propVals[tok], j + 1];
+            }
+        }
+
+        /* Everything else is a count or length followed by a colon */
+        j = str.find(':', i);
+        n = toInteger(str.substr(i + 1, j - i - 1));
+        i = j + 1;
+
+        if(c == 's')
+            return [str.substr(i, n).findReplace(R'<backslash>(.)',
+                {m: m == '\\n' ? '\n' : m.substr(2)}, ReplaceAll), i + n];
+
+        vec = new Vector(n + 1);
+        for(local k = 1; k <= n; k++)
+        {
+            local r = decodeAt(str, i);
+            vec.append(r[1]);
+            i = r[2];
+        }
+
+        switch(c)
+        {
+        case 'l':
+            return [vec.toList(), i];
+        case 'v':
+            return [vec, i];
+        default:
+            tab = new LookupTable(16, 32);
+            for(local k = 1; k < vec.length; k += 2)
+                tab[vec[k]] = vec[k + 1];
+
+            return [tab, i];
+        }
+    }
+
+    /* Make an automatic checkpoint if interval turns have gone by */
+    autosave()
+    {
+        if(interval > 0
+           && libGlobal.totalTurns >= lastCheckpointTurn + interval)
+            checkpoint();
+    }
+;
+
+/*
+ *   Set up the autosave PromptDaemon at the start of play.
+ *   [DELTASAVE EXTENSION]
+ */
+deltaSaveInit: InitObject
+    execute()
+    {
+        new PromptDaemon(deltaSave, &autosave);
+    }
+;
+
+/*
+ *   After an UNDO, RESTORE or RESTART the shadow copy no longer describes the
+ *   state the delta file was built on, so the next checkpoint must be a new
+ *   base.
+ *   [DELTASAVE EXTENSION]
+ */
+deltaSaveReset: PostRestoreObject, PostUndoObject, InitObject
+    execute()
+    {
+        deltaSave.baseNeeded = true;
+    }
+;
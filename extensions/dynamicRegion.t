@@ -93,13 +93,16 @@ class DynamicRegion: Region
             {
                 roomList = valToList(roomList).appendUnique(cur.roomList);
                 foreach(local r in cur.roomList)
+                {
                     r.regions = valToList(r.regions).appendUnique([self]);
+                    r.resetRegions();
+                }
             }
             else
             {
                 roomList = valToList(roomList).appendUnique([cur]);
                 cur.regions = valToList(cur.regions).appendUnique([self]);
-                cur.allRegions = valToList(cur.allRegions).appendUnique([self]);
+                cur.resetRegions();
             }
         }
         
@@ -122,13 +125,16 @@ class DynamicRegion: Region
             {
                 roomList = valToList(roomList) - cur.roomList;
                 foreach(local r in cur.roomList)
+                {
                     r.regions = valToList(r.regions) - self;
+                    r.resetRegions();
+                }
             }
             else
             {
                 roomList = valToList(roomList) - cur;
                 cur.regions = valToList(cur.regions) - self;
-                cur.allRegions = valToList(cur.allRegions) - self;
+                cur.resetRegions();
             }
         }
         
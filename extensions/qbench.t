@@ -0,0 +1,365 @@
+#charset "us-ascii"
+#include "advlite.h"
+
+/*
+ *   QBENCH EXTENSION
+ *
+ *   Microbenchmarks for the sense and scope queries answered by the Q object
+ *   (and by default by QDefaults in query.t).
+ *
+ *   Whole-game replays show whether a game as a whole has got faster or
+ *   slower, but not which query is responsible. This extension builds a set
+ *   of synthetic worlds at preinit, each described by a QBenchWorld object
+ *   giving the depth and fan-out of its containment trees, the number of
+ *   rooms (and whether they're joined in a SenseRegion), which containers
+ *   are closed or transparent and which items are light sources. The QBENCH
+ *   command then times each family of query (scopeList, canSee, canReach,
+ *   canHear, sightBlocker, reachProblem and Thing.containerPathBlock) over
+ *   qBench.iterations rounds in each world and lists the number of
+ *   operations per second.
+ *
+ *   The synthetic worlds are real objects in the game, though nothing leads
+ *   to them, so this extension is meant to be included in a small benchmark
+ *   project rather than in a game to be released. Such a project can set
+ *   qBench.runAtStartup to true to list the results before the first prompt.
+ *
+ *   The extension defines a handful of sample worlds; a benchmark project
+ *   can define its own QBenchWorld objects instead by listing them in
+ *   qBench.worlds.
+ */
+
+
+/*
+ *   A QBenchWorld describes one synthetic world for the benchmarks and holds
+ *   the objects we build for it.
+ */
+class QBenchWorld: object
+    /* The name of this world in the results */
+    name = 'world'
+
+    /* The number of rooms */
+    roomCount = 1
+
+    /*
+     *   Flag: should the rooms be joined in a SenseRegion (so that each can
+     *   see and hear into the others)? This is ignored if the library in use
+     *   doesn't include senseRegion.t.
+     */
+    inSenseRegion = nil
+
+    /*
+     *   The number of levels of objects in each room. Every object above the
+     *   bottom level is a container; those on the bottom level are simple
+     *   Things.
+     */
+    depth = 3
+
+    /* The number of objects directly in each room and each container */
+    fanOut = 3
+
+    /*
+     *   Make every closedEvery-th container a closed one (or none if this is
+     *   0), and every transparentEvery-th closed container transparent (or
+     *   none if this is 0).
+     */
+    closedEvery = 0
+    transparentEvery = 0
+
+    /* 
+     *   The classes we create containers and SenseRegions from. Since
+     *   Container (from extras.t) and SenseRegion (from senseRegion.t) aren't
+     *   in every version of the library, we fall back on a Thing made to
+     *   behave as a container, and on not creating a SenseRegion at all.
+     */
+    containerClass = (defined(Container) ? Container : Thing)
+    regionClass = (defined(SenseRegion) ? SenseRegion : nil)
+    
+    /* Flag: are the rooms dark? */
+    darkRooms = nil
+
+    /* Make every litEvery-th bottom-level object a light source (or none if 0) */
+    litEvery = 0
+
+    /* The rooms, containers and bottom-level objects we've built */
+    rooms = []
+    containers = []
+    leaves = []
+
+    /* The object standing in for the actor whose senses we test */
+    observer = nil
+
+    /*
+     *   The objects we use as the targets of our two-object queries: every
+     *   container and bottom-level object, or up to maxTargets of them spaced
+     *   evenly through the world.
+     */
+    targets = []
+    maxTargets = 60
+
+    /* Build this world */
+    build()
+    {
+        local rvec = new Vector(roomCount);
+        local cvec = new Vector(50);
+        local lvec = new Vector(100);
+
+        for(local i = 1; i <= roomCount; ++i)
+        {
+            local rm = new Room();
+            rm.name = name + ' room ' + i;
+            rm.isLit = !darkRooms;
+            rvec.append(rm);
+
+            buildLevel(rm, 1, cvec, lvec);
+        }
+
+        rooms = rvec.toList();
+        containers = cvec.toList();
+        leaves = lvec.toList();
+
+        /* the observer stands in the first room */
+        observer = new Thing();
+        observer.name = name + ' observer';
+        observer.location = rooms[1];
+
+        /* join the rooms in a SenseRegion if we want to (and can) */
+        if(inSenseRegion && roomCount > 1 && regionClass != nil)
+        {
+            local reg = regionClass.createInstance();
+            reg.rooms = rooms;
+        }
+
+        /* choose our targets */
+        local all = containers + leaves;
+        local step = (all.length() + maxTargets - 1) / maxTargets;
+        local tvec = new Vector(maxTargets);
+
+        for(local i = 1; i <= all.length(); i += step)
+            tvec.append(all[i]);
+
+        targets = tvec.toList();
+    }
+
+    /*
+     *   Build fanOut objects in parent at the given level, adding each
+     *   container to cvec and each bottom-level object to lvec.
+     */
+    buildLevel(parent, level, cvec, lvec)
+    {
+        for(local i = 1; i <= fanOut; ++i)
+        {
+            local obj;
+
+            if(level < depth)
+            {
+                obj = containerClass.createInstance();
+                obj.contType = In;
+                cvec.append(obj);
+
+                if(closedEvery > 0 && cvec.length() % closedEvery == 0)
+                {
+                    obj.isOpen = nil;
+                    obj.isOpenable = true;
+
+                    if(transparentEvery > 0
+                       && (cvec.length() / closedEvery) % transparentEvery == 0)
+                        obj.isTransparent = true;
+                }
+
+                buildLevel(obj, level + 1, cvec, lvec);
+            }
+            else
+            {
+                obj = new Thing();
+                lvec.append(obj);
+
+                if(litEvery > 0 && lvec.length() % litEvery == 0)
+                    obj.isLit = true;
+            }
+
+            obj.name = name + ' item ' + (cvec.length() + lvec.length());
+
+            /* thingPreinit will add us to our location's contents */
+            obj.location = parent;
+        }
+    }
+;
+
+/* A single room with everything in plain view */
+qbenchFlat: QBenchWorld
+    name = 'flat'
+    depth = 1
+    fanOut = 40
+;
+
+/* A single room with deeply nested open containers */
+qbenchDeep: QBenchWorld
+    name = 'deep'
+    depth = 7
+    fanOut = 2
+;
+
+/* Closed containers, some of them transparent */
+qbenchClosed: QBenchWorld
+    name = 'closed'
+    depth = 4
+    fanOut = 3
+    closedEvery = 2
+    transparentEvery = 2
+;
+
+/* Dark rooms lit only by some of their contents */
+qbenchDark: QBenchWorld
+    name = 'dark'
+    depth = 3
+    fanOut = 3
+    darkRooms = true
+    litEvery = 5
+;
+
+/* Several rooms joined in a SenseRegion */
+qbenchRegion: QBenchWorld
+    name = 'region'
+    roomCount = 4
+    inSenseRegion = true
+    depth = 3
+    fanOut = 3
+    closedEvery = 3
+;
+
+/*
+ *   The qBench object builds the worlds at preinit and runs the benchmarks.
+ *   We need to build the worlds before the library preinitializes Things
+ *   and Regions, so that they're set up just like the objects defined in
+ *   the source.
+ */
+qBench: PreinitObject
+    /*
+     *   The worlds to build and benchmark; if this is nil we use every
+     *   QBenchWorld.
+     */
+    worlds = nil
+
+    /* The number of rounds of each query to time in each world */
+    iterations = 200
+
+    /* Flag: should we list the results before the first prompt? */
+    runAtStartup = nil
+
+    /*
+     *   The query families to time. Each entry is [name, perTarget, func]:
+     *   if perTarget is true, each round calls func(world, target) for each
+     *   of the world's targets; otherwise each round calls func(world, nil)
+     *   once.
+     */
+    families = [
+        ['scopeList', nil, {w, t: Q.scopeList(w.observer)}],
+        ['canSee', true, {w, t: Q.canSee(w.observer, t)}],
+        ['canReach', true, {w, t: Q.canReach(w.observer, t)}],
+        ['canHear', true, {w, t: Q.canHear(w.observer, t)}],
+        ['sightBlocker', true, {w, t: Q.sightBlocker(w.observer, t)}],
+        ['reachProblem', true, {w, t: Q.reachProblem(w.observer, t)}],
+        ['containerPathBlock', true,
+            {w, t: w.observer.containerPathBlock(t, &canSeeOut, &canSeeIn)}]
+    ]
+
+    /*
+     *   The results of the last run, as a list of [world name, family name,
+     *   operations, milliseconds] entries, for any code that wants to check
+     *   them against earlier figures.
+     */
+    lastResults = []
+
+    /* Build our worlds */
+    execute()
+    {
+        if(worlds == nil)
+        {
+            local vec = new Vector(10);
+            forEachInstance(QBenchWorld, {w: vec.append(w)});
+            worlds = vec.toList().sort(SortAsc,
+                {a, b: a.sourceTextOrder - b.sourceTextOrder});
+        }
+
+        foreach(local w in worlds)
+            w.build();
+    }
+
+    execAfterMe = [thingPreinit, regionPreinit]
+
+    /* Time every family of query in every world and list the results */
+    run()
+    {
+        local res = new Vector(worlds.length() * families.length());
+
+        "<.p>Q benchmarks: <<iterations>> rounds\n";
+
+        foreach(local w in worlds)
+        {
+            "<.p><<w.name>> (<<w.rooms.length()>> rooms, <<w.containers.length()>>
+            containers, <<w.leaves.length()>> items, <<w.targets.length()>>
+            targets):\n";
+
+            foreach(local fam in families)
+            {
+                local r = timeFamily(w, fam);
+                res.append([w.name, fam[1]] + r);
+
+                "\t<<fam[1]>>: <<r[1]>> ops in <<r[2]>> ms =
+                <<r[2] > 0 ? toString(r[1] * 1000 / r[2]) : '&gt;' + toString(r[1] * 1000)>>
+                ops/sec\n";
+            }
+        }
+
+        "<.p>";
+
+        lastResults = res.toList();
+    }
+
+    /*
+     *   Time one family of query in world w, returning [operations,
+     *   milliseconds].
+     */
+    timeFamily(w, fam)
+    {
+        local func = fam[3];
+        local tlst = fam[2] ? w.targets : [nil];
+        local ops = iterations * tlst.length();
+
+        /* start from a clean heap, so that earlier garbage isn't charged to us */
+        t3RunGC();
+
+        local start = getTime(GetTimeTicks);
+
+        for(local i = 1; i <= iterations; ++i)
+        {
+            foreach(local t in tlst)
+                func(w, t);
+        }
+
+        return [ops, getTime(GetTimeTicks) - start];
+    }
+;
+
+/* Run the benchmarks at startup, if we've been asked to */
+qBenchInit: InitObject
+    execute()
+    {
+        if(qBench.runAtStartup)
+            qBench.run();
+    }
+;
+
+DefineSystemAction(QBench)
+    execAction(cmd)
+    {
+        qBench.run();
+    }
+;
+
+VerbRule(QBench)
+    'qbench'
+    : VerbProduction
+    action = QBench
+    verbPhrase = 'benchmark/benchmarking queries'
+;
@@ -33,12 +33,14 @@ class RuleBook: PreinitObject
     addToContents(ru)
     {
         contents += ru;
+        invalidateOrder();
     }
     
     /* Remove a rule from the contents of this rulebook [RULES EXTENSION] */
     removeFromContents(ru)
     {
         contents -= ru;
+        invalidateOrder();
     }
     
     
@@ -71,18 +73,42 @@ class RuleBook: PreinitObject
         /* Carry out any custom initialization required. */
         initBook(args...);
         
-        /* 
-         *   Make sure that all the Rules in our contents list know that we're
-         *   the RuleBook that's currently calling them. This is necessary in
-         *   case the same Rule is associated with more than one RuleBook.
-         */
-        contents.forEach({ r: r.setRulebook(self) });
+        local validRules;
         
-        /* Extract the subset of Rules that match their conditions. */
-        local validRules = contents.subset({r: r.matchConditions});
-        
-        /* Sort the matching rules in descending order of precedence. */
-        validRules = validRules.sort(SortDesc, {a, b: a.compareTo(b)} );
+        if(cacheOrder)
+        {
+            /* 
+             *   Get the Rules that could plausibly match in the current
+             *   context, already sorted in descending order of precedence.
+             */
+            validRules = candidateRules();
+            
+            /* 
+             *   Make sure that all these Rules know that we're the RuleBook
+             *   that's currently calling them. This is necessary in case the
+             *   same Rule is associated with more than one RuleBook.
+             */
+            validRules.forEach({ r: r.setRulebook(self) });
+            
+            /* Extract the subset of Rules that match their conditions. */
+            validRules = validRules.subset({r: r.matchConditions});
+        }
+        else
+        {
+            /* 
+             *   Make sure that all the Rules in our contents list know that
+             *   we're the RuleBook that's currently calling them. This is
+             *   necessary in case the same Rule is associated with more than
+             *   one RuleBook.
+             */
+            contents.forEach({ r: r.setRulebook(self) });
+            
+            /* Extract the subset of Rules that match their conditions. */
+            validRules = contents.subset({r: r.matchConditions});
+            
+            /* Sort the matching rules in descending order of precedence. */
+            validRules = validRules.sort(SortDesc, {a, b: a.compareTo(b)} );
+        }
         
         /* 
          *   Go through each of the matching rules in turn, calling its follow
@@ -108,6 +134,170 @@ class RuleBook: PreinitObject
     }
     
     
+    /* 
+     *   Flag: should we sort our rules once and then reuse that order, and
+     *   index them by their action, who and where conditions so that only
+     *   those rules that could plausibly match need to have their conditions
+     *   tested? This is true by default. The cached order is recalculated
+     *   whenever a rule is added to or removed from this RuleBook, but if game
+     *   code changes the priority, execBefore, execAfter, action, who or where
+     *   property of one of our rules at runtime it should call that rule's
+     *   rankingChanged() method (or our invalidateOrder() method). A RuleBook
+     *   whose rules compute any of these properties dynamically should
+     *   override this to nil, in which case every rule is tested and the
+     *   matching rules are sorted each time we're followed. [RULES EXTENSION]
+     */
+    cacheOrder = true
+    
+    /*   
+     *   Note that our cached rule order and indexes are out of date, so that
+     *   they'll be rebuilt the next time we're followed. [RULES EXTENSION]
+     */
+    invalidateOrder() { sortedRules = nil; }
+    
+    /*   
+     *   Our rules sorted in descending order of precedence, or nil if this
+     *   needs to be recalculated. [RULES EXTENSION]
+     */
+    sortedRules = nil
+    
+    /*   
+     *   A LookupTable giving the position of each of our rules in the
+     *   sortedRules list. [RULES EXTENSION]
+     */
+    rankTab = nil
+    
+    /*  
+     *   LookupTables mapping Actions, actors and Rooms/Regions respectively to
+     *   lists of those of our rules that are indexed by their action, who or
+     *   where conditions. Each rule is indexed by at most one of these (action
+     *   in preference to who, and who in preference to where). [RULES EXTENSION]
+     */
+    actionTab = nil
+    whoTab = nil
+    whereTab = nil
+    
+    /*   
+     *   The list of our rules that can't be indexed, and so always need to
+     *   have their conditions tested. [RULES EXTENSION]
+     */
+    unindexedRules = nil
+    
+    /* 
+     *   Sort our rules into order of precedence and index them by their
+     *   action, who and where conditions. [RULES EXTENSION]
+     */
+    buildIndex()
+    {
+        sortedRules = contents.sort(SortDesc, {a, b: a.compareTo(b)});
+        
+        rankTab = new LookupTable(32, 64);
+        actionTab = new LookupTable(32, 64);
+        whoTab = new LookupTable(16, 32);
+        whereTab = new LookupTable(16, 32);
+        
+        local vec = new Vector(sortedRules.length);
+        
+        for(local ru in sortedRules, local i = 1 ;; i++)
+        {
+            rankTab[ru] = i;
+            
+            if(ru.indexableProp(&action))
+                addToIndex(actionTab, ru, ru.action);
+            
+            else if(ru.indexableProp(&who))
+                addToIndex(whoTab, ru, ru.who);
+            
+            else if(ru.indexableProp(&where) 
+                    && valToList(ru.where).indexWhich(
+                        {w: !(w.ofKind(Room) || w.ofKind(Region))}) == nil)
+                addToIndex(whereTab, ru, ru.where);
+            
+            else
+                vec.append(ru);
+        }
+        
+        unindexedRules = vec.toList();
+    }
+    
+    /* Add ru to the tab index under each of the keys in vals. [RULES EXTENSION] */
+    addToIndex(tab, ru, vals)
+    {
+        foreach(local key in valToList(vals))
+            tab[key] = valToList(tab[key]) + ru;
+    }
+    
+    /*   
+     *   Return a list, in descending order of precedence, of those of our rules
+     *   that could match in the current context: the unindexed rules plus
+     *   those indexed under an ancestor of the current action, the current
+     *   actor, or the current actor's room or one of its regions.
+     *   [RULES EXTENSION]
+     */
+    candidateRules()
+    {
+        if(sortedRules == nil)
+            buildIndex();
+        
+        /* 
+         *   If there's no current action or actor (e.g. at PreInit) our indexes
+         *   can't narrow anything down.
+         */
+        if(gAction == nil || gActor == nil 
+           || unindexedRules.length == sortedRules.length)
+            return sortedRules;
+        
+        local vec = new Vector(unindexedRules);
+        
+        if(actionTab.getEntryCount() > 0)
+        {
+            foreach(local a in actionAncestors(gAction))
+                vec.appendAll(valToList(actionTab[a]));
+        }
+        
+        vec.appendAll(valToList(whoTab[gActor]));
+        
+        if(whereTab.getEntryCount() > 0)
+        {
+            local rm = gActor.getOutermostRoom();
+            
+            if(rm != nil)
+            {
+                vec.appendAll(valToList(whereTab[rm]));
+                
+                foreach(local reg in valToList(rm.allRegions))
+                    vec.appendAll(valToList(whereTab[reg]));
+            }
+        }
+        
+        return vec.getUnique().sort(SortAsc, {a, b: rankTab[a] - rankTab[b]});
+    }
+    
+    /*  
+     *   Return a list of act and everything it inherits from, i.e. every value
+     *   for which act.ofKind() is true. [RULES EXTENSION]
+     */
+    actionAncestors(act)
+    {
+        local vec = new Vector(8);
+        
+        addAncestors(act, vec);
+        
+        return vec;
+    }
+    
+    /* Service routine for actionAncestors() [RULES EXTENSION] */
+    addAncestors(obj, vec)
+    {
+        vec.append(obj);
+        
+        foreach(local sc in obj.getSuperclassList())
+        {
+            if(vec.indexOf(sc) == nil)
+                addAncestors(sc, vec);
+        }
+    }
+    
     /* 
      *   contValue (continue value) is the value that a Rule in this RuleBook
      *   needs to return to avoid the RuleBook stopping at that Rule (rather
@@ -281,6 +471,39 @@ class Rule: object
      */
     isActive = true
 
+    /*   
+     *   Game code should call this method after changing this Rule's priority,
+     *   execBefore, execAfter, action, who or where property at runtime, so
+     *   that the RuleBooks it belongs to recalculate their cached ordering and
+     *   indexes. [RULES EXTENSION]
+     */
+    rankingChanged()
+    {
+        rulebooks.forEach({r: r.invalidateOrder()});
+    }
+    
+    /*   
+     *   Can this Rule be indexed in its RuleBook by the value of prop (one of
+     *   &action, &who or &where)? It can if prop is defined as a fixed object
+     *   or list of objects rather than as a method. [RULES EXTENSION]
+     */
+    indexableProp(prop)
+    {
+        if(!propDefined(prop))
+            return nil;
+        
+        switch(propType(prop))
+        {
+        case TypeObject:
+            return true;
+        case TypeList:
+            return self.(prop).length > 0
+                && self.(prop).indexWhich({x: dataType(x) != TypeObject}) == nil;
+        default:
+            return nil;
+        }
+    }
+    
     /* Make this Rule active [RULES EXTENSION] */
     activate() { isActive = true; }
     
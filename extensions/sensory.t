@@ -39,6 +39,17 @@ property tooFarAwayToSmellMsg;
  */
 modify SensoryEmanation
     
+    /* 
+     *   Add a dynamically created SensoryEmanation to the emanationControl's
+     *   list, so that it's found without game code having to register it.
+     *   [MODIFIED FOR SENSORY EXTENSION]
+     */
+    construct()
+    {
+        inherited();
+        emanationControl.register(self);
+    }
+    
     /* 
      *   By default we vary our description according to whether the player
      *   character can see the object whose sound or smell we represent. If you
@@ -351,10 +362,22 @@ class SimpleNoise: Noise
  *  [DEFINED IN SENSORY EXTENSION]
  */
 emanationControl: InitObject
-    /* Set up our Daemon at the start of play. [DEFINED IN SENSORY EXTENSION] */
+    /* 
+     *   Set up our Daemon at the start of play, and note every
+     *   SensoryEmanation in the game. [DEFINED IN SENSORY EXTENSION]
+     */
     execute()
     {
         new Daemon(self, &emanate, 1);
+        
+        local vec = new Vector(32);
+        
+        for(local o = firstObj(SensoryEmanation); o != nil; 
+            o = nextObj(o, SensoryEmanation))
+            vec.append(o);
+        
+        emanationList = vec;
+        indexDirty = true;
     }
     
     /* 
@@ -371,6 +394,195 @@ emanationControl: InitObject
             e.emanate();      
     }
     
+    /*   
+     *   A Vector of every SensoryEmanation in the game. This is built at the
+     *   start of play, and SensoryEmanation.construct() adds any created
+     *   dynamically. [DEFINED IN SENSORY EXTENSION]
+     */
+    emanationList = nil
+    
+    /*   
+     *   A LookupTable mapping each Room to a Vector of the SensoryEmanations
+     *   currently within it, whether or not they're emanating (so that there's
+     *   no need to update it when isEmanating changes). This saves us from
+     *   having to search through the allContents of every room in sensory
+     *   range each turn. [DEFINED IN SENSORY EXTENSION]
+     */
+    roomTab = nil
+    
+    /*   
+     *   A LookupTable mapping each SensoryEmanation to the list of Rooms it's
+     *   filed under in roomTab (more than one if it's a MultiLoc, or is in
+     *   one), so that when it moves we can take it out of those rooms'
+     *   entries. [DEFINED IN SENSORY EXTENSION]
+     */
+    placeTab = nil
+    
+    /*   
+     *   Flag: does our roomTab need building from scratch? Once it's built,
+     *   registrations and movements just update the entries for the rooms
+     *   concerned. [DEFINED IN SENSORY EXTENSION]
+     */
+    indexDirty = true
+    
+    /*  Add a SensoryEmanation to our list. [DEFINED IN SENSORY EXTENSION] */
+    register(obj)
+    {
+        if(emanationList == nil)
+            emanationList = new Vector(32);
+        
+        emanationList.appendUnique(obj);
+        
+        if(roomTab != nil && !indexDirty)
+            place(obj, roomsOf(obj));
+    }
+    
+    /*  Rebuild our roomTab from our emanationList. [DEFINED IN SENSORY EXTENSION] */
+    buildIndex()
+    {
+        roomTab = new LookupTable(32, 64);
+        placeTab = new LookupTable(32, 64);
+        
+        foreach(local o in valToList(emanationList))
+            place(o, roomsOf(o));
+        
+        indexDirty = nil;
+    }
+    
+    /*   
+     *   Return a list of the Rooms obj is in. This is usually just its
+     *   outermost room, but a MultiLoc (or anything inside one) is in every
+     *   room that any of its locations is in. [DEFINED IN SENSORY EXTENSION]
+     */
+    roomsOf(obj)
+    {
+        if(obj == nil)
+            return [];
+        
+        if(obj.ofKind(Room))
+            return [obj];
+        
+        if(obj.ofKind(MultiLoc))
+            return roomsOfList(obj.locationList);
+        
+        return roomsOf(obj.location);
+    }
+    
+    /*  
+     *   Return a list of the Rooms that any of the objects in lst is in.
+     *   [DEFINED IN SENSORY EXTENSION]
+     */
+    roomsOfList(lst)
+    {
+        local rms = [];
+        
+        foreach(local loc in valToList(lst))
+            rms = rms.appendUnique(roomsOf(loc));
+        
+        return rms;
+    }
+    
+    /*  
+     *   File the SensoryEmanation e under each of the rooms in rms (or under no
+     *   room if rms is empty), taking it out of the entries for any rooms it
+     *   was filed under before and is no longer in. [DEFINED IN SENSORY
+     *   EXTENSION]
+     */
+    place(e, rms)
+    {
+        local old = valToList(placeTab[e]);
+        
+        foreach(local rm in old)
+        {
+            if(rms.indexOf(rm) == nil)
+                roomTab[rm].removeElement(e);
+        }
+        
+        foreach(local rm in rms)
+        {
+            if(old.indexOf(rm) != nil)
+                continue;
+            
+            local vec = roomTab[rm];
+            if(vec == nil)
+                roomTab[rm] = vec = new Vector(4);
+            
+            vec.append(e);
+        }
+        
+        if(rms.length() == 0)
+            placeTab.removeElement(e);
+        else
+            placeTab[e] = rms;
+    }
+    
+    /*   
+     *   Note that obj has just been added to cont (if gone is nil) or removed
+     *   from cont (if gone is true), and refile any SensoryEmanations it
+     *   carries with it. Only the entries for the rooms it's left and the
+     *   rooms it's entered change. [DEFINED IN SENSORY EXTENSION]
+     */
+    noteMoved(obj, cont, gone)
+    {
+        /* 
+         *   If we haven't built our index yet, or need to rebuild it anyway,
+         *   there's nothing to update.
+         */
+        if(roomTab == nil || indexDirty)
+            return;
+        
+        /* 
+         *   Work out which rooms obj is now in. A MultiLoc's locationList
+         *   hasn't been updated yet when its contents are changed, so we
+         *   allow for the change ourselves; anything else that's been removed
+         *   from its container is nowhere until it's added to another one.
+         */
+        local rms;
+        
+        if(obj.ofKind(MultiLoc))
+        {
+            local locs = valToList(obj.locationList);
+            rms = roomsOfList(gone ? locs - cont : locs.appendUnique([cont]));
+        }
+        else
+            rms = (gone ? [] : roomsOf(cont));
+        
+        if(obj.ofKind(SensoryEmanation))
+            place(obj, rms);
+        
+        if(obj.contents.length() > 0)
+        {
+            foreach(local o in obj.allContents)
+            {
+                if(!o.ofKind(SensoryEmanation))
+                    continue;
+                
+                /* 
+                 *   A MultiLoc within obj is also in the rooms of any of its
+                 *   locations outside obj.
+                 */
+                if(o.ofKind(MultiLoc))
+                    place(o, rms.appendUnique(roomsOfList(
+                        o.locationList.subset({x: x != obj && !x.isIn(obj)}))));
+                else
+                    place(o, rms);
+            }
+        }
+    }
+    
+    /*   
+     *   Return a list of all the SensoryEmanations (emanating or not) in rm.
+     *   [DEFINED IN SENSORY EXTENSION]
+     */
+    emanationsIn(rm)
+    {
+        if(indexDirty || roomTab == nil)
+            buildIndex();
+        
+        local vec = roomTab[rm];
+        
+        return vec == nil ? [] : vec.toList();
+    }
     
     /*  
      *   Construct a list of SensoryEmanations that can currently be sensed by
@@ -379,17 +591,19 @@ emanationControl: InitObject
     buildEmanationList   
     {
         local pc = gPlayerChar;
+        local here = pc.getOutermostRoom;
         
         /* 
          *   First get a list of all the SensoryEmanations in the player
          *   character's current room that can be sensed by the player character
          */
-        local lst = pc.getOutermostRoom.allContents.subset(
-            {o: canSense(pc, o)});
+        local lst = emanationsIn(here).subset({o: canSense(pc, o)});
         
         /*  
          *   If the SenseRegion class is defined then add all the
-         *   SensoryEmanations that can be sensed in remote locations
+         *   SensoryEmanations that can be sensed in remote locations. The
+         *   audibleRooms and smellableRooms lists are calculated by SenseRegion
+         *   at PreInit, so we only need to visit the emanations in those rooms.
          */
         if(defined(SenseRegion))
         {
@@ -401,8 +615,8 @@ emanationControl: InitObject
              *   current location, all all the currently emanating Noises that
              *   the player character can hear.
              */
-            foreach(local rm in valToList(pc.getOutermostRoom.audibleRooms))
-                remoteLst += rm.allContents.subset(
+            foreach(local rm in valToList(here.audibleRooms))
+                remoteLst += emanationsIn(rm).subset(
                     {o: o.isEmanating && o.ofKind(Noise) && Q.canHear(pc, o)});
             
             /* 
@@ -410,8 +624,8 @@ emanationControl: InitObject
              *   current location, all all the currently emanating Odors that
              *   the player character can smell.
              */
-            foreach(local rm in valToList(pc.getOutermostRoom.smellableRooms))
-                remoteLst += rm.allContents.subset(
+            foreach(local rm in valToList(here.smellableRooms))
+                remoteLst += emanationsIn(rm).subset(
                     {o: o.isEmanating && o.ofKind(Odor) && Q.canSmell(pc, o)});
             
             /* 
@@ -698,6 +912,22 @@ modify Thing
         return true;
     }
     
+    /* 
+     *   Keep the emanationControl's room index up to date whenever anything
+     *   changes its containment. [MODIFIED FOR SENSORY EXTENSION]
+     */
+    addToContents(obj, vec?)
+    {
+        inherited(obj, vec);
+        emanationControl.noteMoved(obj, self, nil);
+    }
+    
+    removeFromContents(obj, vec?)
+    {
+        inherited(obj, vec);
+        emanationControl.noteMoved(obj, self, true);
+    }
+    
     /* Our associated Odor object, if we have one [SENSORY EXTENSION]*/
     smellObj = (contents.valWhich({o: o.ofKind(Odor)}))
     
@@ -717,7 +947,7 @@ modify Room
         
         if(traveler == gPlayerChar)
         {
-            local lst = allContents.subset({o: o.ofKind(SensoryEmanation)});             
+            local lst = emanationControl.emanationsIn(self);
             
             /* 
              *   If the SenseRegion class is included, then we need to deal with
@@ -732,13 +962,13 @@ modify Room
                     
                     /* First add all the Noises in the remote rooms we can hear */
                     for(local rm in getOutermostRoom.audibleRooms)
-                        lst.appendUnique(rm.allContents.subset({o:
-                            o.ofKind(Noise)}));
+                        lst.appendUnique(emanationControl.emanationsIn(rm)
+                                         .subset({o: o.ofKind(Noise)}));
                     
                     /* Then add all the Odors in the remote rooms we can smell */
                     for(local rm in getOutermostRoom.smellableRooms)
-                        lst.appendUnique(rm.allContents.subset({o:
-                            o.ofKind(Odor)}));
+                        lst.appendUnique(emanationControl.emanationsIn(rm)
+                                         .subset({o: o.ofKind(Odor)}));
                     
                     /* 
                      *   Finally remove all the Odors that can't be smelled from
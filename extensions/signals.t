@@ -44,6 +44,28 @@ Signal: Relation
 	 *   [SIGNALS EXTENSION]
      */
     emit(sender, [args])   
+    {
+        /* Note that we've been emitted (for profiling purposes) */
+        emitCount++;
+        
+        /* 
+         *   If the signalManager is queueing signals, leave it to dispatch us
+         *   at the end of the current turn phase; otherwise dispatch us
+         *   straight away.
+         */
+        if(signalManager.queueSignals)
+            signalManager.enqueue(self, sender, args);
+        else
+            dispatchFrom(sender, args);
+    }
+    
+    /* 
+     *   Assign any additional arguments to our properties, then notify every
+     *   object related to sender by us to handle us as a signal from sender.
+     *   This is called from emit() in synchronous mode and from the
+     *   signalManager when it flushes its queue. [SIGNALS EXTENSION]
+     */
+    dispatchFrom(sender, args)
     {
         local prop, val;
         
@@ -79,9 +101,33 @@ Signal: Relation
             self.(prop) = val;
         }
         
-        relatedTo(sender).forEach({ obj: obj.dispatchSignal(sender, self) });
+        local lst = relatedTo(sender);
+        
+        /* Note how many receivers we're about to be dispatched to. */
+        dispatchCount += lst.length;
+        
+        lst.forEach({ obj: obj.dispatchSignal(sender, self) });
     }
     
+    /*   
+     *   Flag: when the signalManager is queueing signals, should repeated
+     *   emissions of this signal from the same sender within the same turn
+     *   phase be coalesced into a single dispatch (using the arguments from the
+     *   most recent emission)? Override to nil on signals whose receivers need
+     *   to see every intermediate emission. [SIGNALS EXTENSION]
+     */
+    coalesce = true
+    
+    /*   
+     *   Profiling counters: the number of times we've been emitted, the number
+     *   of receivers we've been dispatched to, and the number of emissions
+     *   that have been absorbed into an earlier queued emission. These can be
+     *   reset with signalManager.resetCounters(). [SIGNALS EXTENSION]
+     */
+    emitCount = 0
+    dispatchCount = 0
+    coalescedCount = 0
+    
     /* 
      *   A list of pointers to the properties to which additional arguments to
      *   our emit method should be assigned. [SIGNALS EXTENSION]
@@ -89,10 +135,13 @@ Signal: Relation
     propList = []
     
 	/*
-	 *   A LookupTable liniking objects that might emit this signal (potential senders) to potential
-	 *   receivers of this signal, so that notifications can be sent from the former to the latter.
-	 *   Game code should not need to manipulate this table directly; it should instead be updated via
-	 *   the supplied connect() and unconnect() functions.
+	 *   A LookupTable linking objects that might emit this signal (potential senders) to a
+	 *   LookupTable of potential receivers of this signal, which in turn maps each receiver to
+	 *   the handler property to use, so that notifications can be sent from the former to the
+	 *   latter. Nesting the tables this way means a handler can be looked up without allocating a
+	 *   new [sender, receiver] key list on every dispatch. Game code should not need to manipulate
+	 *   this table directly; it should instead be updated via the supplied connect() and
+	 *   unconnect() functions.
 	 *   
 	 *   [SIGNALS EXTENSION]
 	 */
@@ -103,17 +152,42 @@ Signal: Relation
         if(dispatchTab == nil)
             dispatchTab = new LookupTable();
         
-        dispatchTab[[sender, receiver]] = handler;
+        local tab = dispatchTab[sender];
+        
+        if(tab == nil)
+            dispatchTab[sender] = tab = new LookupTable(8, 8);
+        
+        tab[receiver] = handler;
     }
     
     removeHandler(sender, receiver)
     {
-        if(dispatchTab != nil)
+        local tab;
+        
+        if(dispatchTab != nil && (tab = dispatchTab[sender]) != nil)
         {
-            dispatchTab.removeElement([sender, receiver]);
+            tab.removeElement(receiver);
+            
+            /* Don't keep empty receiver tables hanging around. */
+            if(tab.getEntryCount() == 0)
+                dispatchTab.removeElement(sender);
         }
     }
     
+    /*  
+     *   Return the handler property registered for receiver when it receives
+     *   this signal from sender, or nil if there isn't one. [SIGNALS EXTENSION]
+     */
+    handlerFor(sender, receiver)
+    {
+        local tab;
+        
+        if(dispatchTab != nil && (tab = dispatchTab[sender]) != nil)
+            return tab[receiver];
+        
+        return nil;
+    }
+    
 ;
 
 
@@ -142,6 +216,132 @@ DefSignal(pull, pull);
 DefSignal(feel, feel);
 
 
+/*
+ *   The signalManager optionally queues signals rather than dispatching them
+ *   the moment they're emitted. When queueSignals is true, signals emitted
+ *   during a turn phase (the action phase or the daemon phase) are held until
+ *   the end of that phase and then dispatched in the order they were first
+ *   emitted, with repeated emissions of the same signal by the same sender
+ *   coalesced into one (unless the Signal's coalesce property is nil). This
+ *   prevents a bulk move or a chain reaction of state changes from dispatching
+ *   the same signal to the same receivers over and over again.
+ *
+ *   [SIGNALS EXTENSION]
+ */
+signalManager: InitObject
+    /* 
+     *   Flag: should signals be queued and dispatched at the end of each turn
+     *   phase? By default they aren't, so that signals are dispatched
+     *   synchronously from emit(), which is the traditional behaviour. Game
+     *   code can set this to true to use the queued signal bus.
+     */
+    queueSignals = nil
+    
+    /*   
+     *   The maximum number of passes we'll make through the queue in a single
+     *   flush. Signals emitted by handlers while we're flushing are dispatched
+     *   in a further pass; this limit stops a pair of handlers that keep
+     *   signalling each other from looping forever.
+     */
+    maxFlushPasses = 10
+    
+    /* 
+     *   Add a signal emitted by sender with args to our queue, or merge it
+     *   with an emission of the same signal by the same sender that's already
+     *   waiting to be dispatched.
+     */
+    enqueue(signal, sender, args)
+    {
+        if(pendingQueue == nil)
+        {
+            pendingQueue = new Vector(16);
+            pendingTab = new LookupTable(16, 32);
+        }
+        
+        if(signal.coalesce)
+        {
+            local tab = pendingTab[signal];
+            local idx;
+            
+            if(tab == nil)
+                pendingTab[signal] = tab = new LookupTable(8, 8);
+            
+            /* 
+             *   If this signal from this sender is already queued, just update
+             *   its arguments to the latest ones.
+             */
+            if((idx = tab[sender]) != nil)
+            {
+                pendingQueue[idx] = [signal, sender, args];
+                signal.coalescedCount++;
+                return;
+            }
+            
+            tab[sender] = pendingQueue.length + 1;
+        }
+        
+        pendingQueue.append([signal, sender, args]);
+    }
+    
+    /* 
+     *   Dispatch every signal in our queue, together with any signals emitted
+     *   by their handlers, up to maxFlushPasses passes.
+     */
+    flush()
+    {
+        for(local pass = 1; pendingQueue != nil && pendingQueue.length > 0
+            && pass <= maxFlushPasses; pass++)
+        {
+            /* 
+             *   Take a copy of the current queue and start a fresh one, so that
+             *   anything emitted by a handler is queued for the next pass.
+             */
+            local lst = pendingQueue.toList();
+            pendingQueue.setLength(0);
+            pendingTab = new LookupTable(16, 32);
+            
+            foreach(local cur in lst)
+                cur[1].dispatchFrom(cur[2], cur[3]);
+            
+            flushCount++;
+        }
+    }
+    
+    /* Our queue of [signal, sender, args] entries awaiting dispatch. */
+    pendingQueue = nil
+    
+    /*   
+     *   A LookupTable mapping each queued Signal to a LookupTable mapping each
+     *   sender to that entry's index in the pendingQueue.
+     */
+    pendingTab = nil
+    
+    /* 
+     *   Set up a PromptDaemon to flush our queue before each command prompt,
+     *   to catch any signals emitted by actions (such as SystemActions) that
+     *   don't go through the normal afterAction() and turnSequence() cycle.
+     */
+    execute()
+    {
+        new PromptDaemon(self, &flush);
+    }
+    
+    /* The number of flush passes we've made (for profiling purposes). */
+    flushCount = 0
+    
+    /* Reset the profiling counters on every Signal and on ourselves. */
+    resetCounters()
+    {
+        forEachInstance(Signal, function(sig) {
+            sig.emitCount = 0;
+            sig.dispatchCount = 0;
+            sig.coalescedCount = 0;
+        });
+        
+        flushCount = 0;
+    }
+;
+
  /*
   * MODIFICATIONS TO TadsObject for SIGNALS EXTENSION
   *
@@ -176,16 +376,16 @@ modify TadsObject
      */    
     dispatchSignal(sender, signal)
     {
-        local prop;       
-        
-        if(signal.dispatchTab != nil && signal.dispatchTab[[sender, self]] != nil)
-            prop = signal.dispatchTab[[sender, self]];
+        local prop = signal.handlerFor(sender, self);       
         
-        else if(signal.propDefined(&handleProp) 
-                && signal.propType(&handleProp) == TypeProp)
-            prop = signal.handleProp;
-        else
-            prop = &handle;
+        if(prop == nil)
+        {
+            if(signal.propDefined(&handleProp) 
+               && signal.propType(&handleProp) == TypeProp)
+                prop = signal.handleProp;
+            else
+                prop = &handle;
+        }
         
         if(propDefined(prop))
             self.(prop)(sender, signal);
@@ -352,6 +552,29 @@ modify TAction
     }
 ;
 
+modify Action
+    /* 
+     *   Dispatch any signals queued during the action phase before the usual
+     *   after action notifications, so that they can react to them.
+     *   [SIGNALS EXTENSION]
+     */
+    afterAction()
+    {
+        signalManager.flush();
+        inherited();
+    }
+    
+    /* 
+     *   Dispatch any signals queued by daemons, fuses and agenda items at the
+     *   end of the turn. [SIGNALS EXTENSION]
+     */
+    turnSequence()
+    {
+        inherited();
+        signalManager.flush();
+    }
+;
+
 modify Take
    /* [SIGNALS EXTENSION] */  
     signal = takeSignal
@@ -19,11 +19,31 @@ modify Thing
     /* Our total weight, including the weight of our contents [WEIGHT EXTENSION */
     totalWeight = (weight + getWeightWithin())
     
-    /* The total weight of our contents, excluding our own weight. [WEIGHT EXTENSION] */
+    /* 
+     *   The total weight of our contents, excluding our own weight. This is
+     *   cached along with our other containment aggregates, so repeated
+     *   weight checks don't have to walk the whole of our contents tree each
+     *   time. [WEIGHT EXTENSION]
+     */
     getWeightWithin()
     {       
-        return totalWeightIn(contents);
+        checkAggregateStamp();
+        
+        if(weightWithinCache == nil)
+            weightWithinCache = totalWeightIn(contents);
+        
+        return weightWithinCache;
     }    
+    
+    /* Our cached getWeightWithin() value [WEIGHT EXTENSION] */
+    weightWithinCache = nil
+    
+    /* Discard our cached weight along with our other aggregates [WEIGHT EXTENSION] */
+    clearAggregates()
+    {
+        inherited();
+        weightWithinCache = nil;
+    }
    
     /* 
      *   The total weight of the items we're carrying, excluding anything worn
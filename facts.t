@@ -162,22 +162,13 @@ class Fact: object
      */
     defaultTruthValue = true
     
-    /* Obtain a list of everything that knows this fact */
+    /* 
+     *   Obtain a list of everything that knows this fact. This is maintained by the factManager
+     *   as things are informed of or forget facts, so we don't need to search the whole game.
+     */
     currentlyKnownBy()
     {
-        /* Set up a new Vector */
-        local vec = new Vector;
-        
-        /* Iterate through every Thing in the game. */
-        for(local obj = firstObj(Thing); obj != nil; obj = nextObj(obj, Thing))
-        {
-            /* If obj knows about us, add obj to our vector. */
-            if(obj.knowsAbout(self.name))
-                vec.append(obj);
-        }        
-        
-        /* Convert the Vector to a List and return the result. */
-        return vec.toList();
+        return factManager.knowersOf(name);
     }
     
     /* Initialise this fact at preInit. */
@@ -495,6 +486,157 @@ factManager: PreinitObject
         
         /* Add the new Fact to our factTab. */
         factTab[fact.name] = fact;
+        
+        /* Index the new Fact under each of the topics it relates to. */
+        indexTopics(fact);
+    }
+    
+    /* 
+     *   A LookupTable mapping each topic (Topic or Thing) to the list of Facts that relate to it,
+     *   so that we can find the facts relating to a topic without looking through every fact an
+     *   actor knows.
+     */
+    topicTab = nil
+    
+    /* 
+     *   Add fact to our topicTab under each of its topics. If game code changes the topics list of
+     *   a Fact during play, it should call unindexTopics(fact) before the change and
+     *   indexTopics(fact) after it.
+     */
+    indexTopics(fact)
+    {
+        if(topicTab == nil)
+            topicTab = new LookupTable(30, 30);
+        
+        foreach(local top in valToList(fact.topics))
+            topicTab[top] = valToList(topicTab[top]).appendUnique([fact]);
+    }
+    
+    /* Remove fact from our topicTab. */
+    unindexTopics(fact)
+    {
+        if(topicTab == nil)
+            return;
+        
+        foreach(local top in valToList(fact.topics))
+            topicTab[top] = valToList(topicTab[top]) - fact;
+    }
+    
+    /* 
+     *   A LookupTable mapping each fact tag to a LookupTable whose keys are the actors (and other
+     *   Things, such as Consultables) that currently know it. This is kept in step with every
+     *   Thing's informedNameTab by Thing.setInformed() and Thing.forget(), so that questions such
+     *   as who knows a fact can be answered without searching every Thing in the game.
+     */
+    knowerTab = nil
+    
+    /* Note that obj has been informed of tag. */
+    noteInformed(tag, obj)
+    {
+        if(knowerTab == nil)
+            knowerTab = new LookupTable(64, 64);
+        
+        local tab = knowerTab[tag];
+        
+        if(tab == nil)
+            knowerTab[tag] = tab = new LookupTable(8, 8);
+        
+        tab[obj] = true;
+    }
+    
+    /* Note that obj has forgotten tag. */
+    noteForgotten(tag, obj)
+    {
+        local tab;
+        
+        if(knowerTab != nil && (tab = knowerTab[tag]) != nil)
+            tab.removeElement(obj);
+    }
+    
+    /* 
+     *   Rebuild our knowerTab from every Thing's informedNameTab, for use when those tables have
+     *   been changed without going through setInformed() and forget() (by the DELTASAVE
+     *   extension, for example).
+     */
+    rebuildKnowers()
+    {
+        knowerTab = nil;
+        
+        forEachInstance(Thing, function(obj) {
+            if(obj.informedNameTab != nil)
+                obj.informedNameTab.forEachAssoc({tag, val: noteInformed(tag, obj)});
+        });
+    }
+    
+    /* Return a list of everything that currently knows tag. */
+    knowersOf(tag)
+    {
+        local tab;
+        
+        if(knowerTab == nil || (tab = knowerTab[tag]) == nil)
+            return [];
+        
+        return tab.keysToList();
+    }
+    
+    /* 
+     *   Return a list of the Facts relating to topic that actor knows. We look through whichever
+     *   is likely to be shorter, the list of facts relating to the topic or the list of facts the
+     *   actor knows.
+     */
+    factsKnownAbout(actor, topic)
+    {
+        local tab = actor.informedNameTab;
+        
+        if(tab == nil || topicTab == nil)
+            return [];
+        
+        local lst = valToList(topicTab[topic]);
+        
+        if(lst.length <= tab.getEntryCount())
+            return lst.subset({f: tab[f.name] != nil});
+        
+        local vec = new Vector(16);
+        local fact;
+        
+        tab.forEachAssoc(function(key, val) {
+            if(val != nil && (fact = getFact(key)) != nil
+               && valToList(fact.topics).indexOf(topic))
+                vec.append(fact);
+        });
+        
+        return vec.toList();
+    }
+    
+    /* Return a list of the fact tags that a knows but b doesn't. */
+    tagsKnownByNotBy(a, b)
+    {
+        if(a.informedNameTab == nil)
+            return [];
+        
+        local btab = b.informedNameTab;
+        
+        return a.informedNameTab.keysToList().subset(
+            {t: a.informedNameTab[t] != nil && (btab == nil || btab[t] == nil)});
+    }
+    
+    /* Return a list of the fact tags known to both a and b. */
+    tagsKnownByBoth(a, b)
+    {
+        local atab = a.informedNameTab, btab = b.informedNameTab;
+        
+        if(atab == nil || btab == nil)
+            return [];
+        
+        /* Iterate over the smaller table, checking membership in the larger. */
+        if(atab.getEntryCount() > btab.getEntryCount())
+        {
+            local t = atab;
+            atab = btab;
+            btab = t;
+        }
+        
+        return atab.keysToList().subset({t: atab[t] != nil && btab[t] != nil});
     }
     
     /* Retrieve a Fact from our factTab via its name (passed as the tag parameter. */    
@@ -623,41 +765,17 @@ class FactHelper: object
         tagList = [];
         
         /* 
-         *   If our actor's informedNameTab hasn't been created, return an empty list, since there's
-         *   nothing to look up.
+         *   Get the relevant Facts known to our actor that are associated with the topic matched
+         *   by our TopicEntry; the factManager indexes Facts by topic so we don't need to look
+         *   through everything our actor knows.
          */
-        if(actor.informedNameTab == nil)
-            return [];
-        
-        /* Set up a new Vector to build our collection of Facts. */
-        local vec = new Vector();
+        local lst = factManager.factsKnownAbout(actor, top).subset({f: f.relevant});
         
-        /* Set up a local variable to store a current Fact object.*/
-        local factObj;
+        /* Note the names of the facts we found. */
+        tagList = lst.mapAll({f: f.name});
         
-        /* Get a list of keys (= Fact names) from our actor's informedNameTab */
-        local keyList = actor.informedNameTab.keysToList();
-        
-        /* Iterate through our list of keys. */
-        foreach(local fkey in keyList)
-        {
-            /* Retrieve the Fact object corresponding to the current key. */
-            factObj = factManager.getFact(fkey);
-            
-            /* 
-             *   If we found a Fact object and the topic matched by our TopicEntry is in the list of
-             *   the Fact object's list of associated topics, add the current key to our tagList and
-             *   append the Fact object to our vector.
-             */
-            if(factObj && factObj.relevant && factObj.topics.find(top))
-            {
-                tagList += fkey;
-                vec.append(factObj);
-            }
-        }
-        
-        /* Sort the vector. convert it to a list, and then return the result. */
-        return vec.sort(true, {a, b: a.adjustedPriority - b.adjustedPriority}).toList();        
+        /* Sort the list and return the result. */
+        return lst.sort(true, {a, b: a.adjustedPriority - b.adjustedPriority});        
         
     }
     
@@ -1457,6 +1575,24 @@ modify AltTopic
     revealing = location.revealing
 ;
 
+/* 
+ *   Modifications to Thing to keep the factManager's knowerTab in step with what each Thing has
+ *   been informed about.
+ */
+modify Thing
+    setInformed(tag, val?)
+    {
+        inherited(tag, val);
+        factManager.noteInformed(tag, self);
+    }
+    
+    forget(tag)
+    {
+        inherited(tag);
+        factManager.noteForgotten(tag, self);
+    }
+;
+
 /* 
  *   modify actorPreinit so that factMananger's happens first. This ensures that factManager's
  *   factTab has been populated and is availabe to actor-related object preinitialization.
@@ -27,9 +27,11 @@ property achieved;
 property eventList;
 
 /* HintOpener provides some properties common to Goal and ExtraHint, in particuar
- * those relating to opening and closing Goals and ExtraHints.
+ * those relating to opening and closing Goals and ExtraHints. If a Goal or ExtraHint
+ * defines conditionDeps (see ReactiveCondition), its openWhen and closeWhen conditions
+ * are only re-evaluated once something they depend on has changed.
  */
-class HintOpener: object
+class HintOpener: ReactiveCondition
     /*
      *   An optional object that, when seen by the player character, opens
      *   this goal.  It's often convenient to declare a goal open as soon
@@ -336,7 +338,7 @@ class Goal: MenuTopicItem, HintMenuObject, HintOpener
          *   Open.  Likewise, if our gating achievement has been scored,
          *   open the goal.  
          */
-        if (goalState == UndiscoveredGoal && openWhen)
+        if (goalState == UndiscoveredGoal && checkCondition(&openWhen))
         {
             /* 
              *   the player has encountered our gating object, so open
@@ -351,7 +353,8 @@ class Goal: MenuTopicItem, HintMenuObject, HintOpener
          *   goal has been achieved, there's no need to offer hints on the
          *   topic any longer 
          */
-        if (goalState is in (UndiscoveredGoal, OpenGoal) && closeWhen)
+        if (goalState is in (UndiscoveredGoal, OpenGoal) 
+            && checkCondition(&closeWhen))
         {
             /* the goal has been achieved, so close it */
             goalState = ClosedGoal;
@@ -767,7 +770,7 @@ class ExtraHint: HintOpener
      */
     checkClose()
     {       
-        return hintDone || closeWhen;
+        return hintDone || checkCondition(&closeWhen);
     }
        
             
@@ -796,7 +799,7 @@ class ExtraHint: HintOpener
             return nil;
         }
         
-        if(openWhen)
+        if(checkCondition(&openWhen))
         {
             if(openedWhen == nil)
                 openedWhen = libGlobal.totalTurns;
@@ -270,8 +270,18 @@ buildMessage(id, txt, [args])
             txt = txt.substr(bar + 1);
     }
 
+    /* if there are no parameters, there's nothing left to do */
+    if (txt.find('{') == nil)
+        return txt;
+    
     /* get the message object */
     local mo = MessageParams.langObj;
+    
+    /* 
+     *   set up a vector for the parameters in each sentence; we empty and
+     *   reuse it for each sentence in turn 
+     */
+    local plst = new Vector(10);
 
     /* apply substitutions */
     for (local i = 1 ; i <= txt.length() ; )
@@ -290,7 +300,7 @@ buildMessage(id, txt, [args])
          *   scanned the entire sentence before we expand the verb.
          */
         ctx.startSentence();
-        local plst = new Vector(10);
+        plst.setLength(0);
         for (local j = i ; ; )
         {
             /* find the next parameter */
@@ -459,6 +469,8 @@ enum vPossessive;
 class MessageCtx: object
     construct(args)
     {
+        NoteAlloc(MessageCtx);
+        
         /* remember the message arguments */
         self.args = args;
 
@@ -477,7 +489,7 @@ class MessageCtx: object
         subj = nil;
         vobj = nil;
         gotVerb = nil;
-        reflexiveAnte.clear();
+        clearReflexiveAnte();
 
         /* note that we're on the initial scan */
         prescan = true;
@@ -503,7 +515,7 @@ class MessageCtx: object
          *   same sentence), so we generally don't care about anything we
          *   found later in the same sentence. 
          */
-        reflexiveAnte.clear();
+        clearReflexiveAnte();
 
         /* we're no longer on the initial scan */
         prescan = nil;
@@ -806,6 +818,16 @@ class MessageCtx: object
      */
     reflexiveAnte = perInstance(new Vector(5))
     
+    /* 
+     *   Clear the reflexive antecedent list. Most messages never note one,
+     *   so if we haven't created the list yet we leave it until we need it.
+     */
+    clearReflexiveAnte()
+    {
+        if (propDefined(&reflexiveAnte, PropDefDirectly))
+            reflexiveAnte.clear();
+    }
+    
     subjPlural()
     {
         if(subj.isGenderNeutral && lastParam.ofKind(Pronoun))
@@ -564,6 +564,121 @@ class Script: object
      */
     curScriptState = 0
 ;
+
+/* ------------------------------------------------------------------------ */
+/*
+ *   A ReactiveCondition is a mix-in class for objects, such as Scenes, hint
+ *   Goals and ExtraHints, whose condition properties (startsWhen, openWhen,
+ *   closeWhen and the like) the library polls every turn.  By default it
+ *   makes no difference, but if an object lists the values its conditions
+ *   depend on in its conditionDeps property, the library only re-evaluates a
+ *   condition that was last found to be nil once one of those values has
+ *   changed.
+ *
+ *   We define this in misc.t so that both scene.t and hintsys.t can use it
+ *   even though either may be excluded from the build.
+ */
+class ReactiveCondition: object
+    /*
+     *   The list of values our conditions depend on, or nil (the default)
+     *   if our conditions are simply to be evaluated every time they're
+     *   checked.  Each element of the list may be:
+     *
+     *.  - a property pointer, meaning the value of that property on self;
+     *.  - a two-element list [obj, prop], meaning the value of obj.(prop);
+     *.  - an object, meaning that object's location.
+     *
+     *   For example, a Scene that starts when the player character enters
+     *   the cellar carrying the lamp might define:
+     *
+     *.  conditionDeps = [[gPlayerChar, &location], lamp]
+     *
+     *   Note that values are compared with ==, so a dependency on a Vector
+     *   or LookupTable only notices if it's replaced, not if it's modified
+     *   in place.  Any condition whose value depends on anything not listed
+     *   here will behave incorrectly, so if in doubt leave this as nil.
+     */
+    conditionDeps = nil
+
+    /*
+     *   Evaluate the condition property prop, unless we've already found it
+     *   to be nil and none of our conditionDeps has changed since, in which
+     *   case we simply return nil.  We only ever skip conditions that were
+     *   nil, since a true condition normally triggers something that
+     *   changes the object's state.
+     */
+    checkCondition(prop)
+    {
+        /* if we have no dependencies, just evaluate the condition */
+        if (conditionDeps == nil)
+            return self.(prop);
+
+        /* take a snapshot of the values we depend on */
+        local snap = conditionDeps.mapAll({ d: conditionDepValue(d) });
+
+        /* if they haven't changed since prop was last nil, it still is */
+        if (condSnaps_ != nil && condSnaps_[prop] == snap)
+        {
+            ++ReactiveCondition.skipCount;
+            return nil;
+        }
+
+        /* otherwise evaluate it */
+        ++ReactiveCondition.evalCount;
+        local val = self.(prop);
+
+        /* if it's nil, note the snapshot; otherwise forget any we had */
+        if (val == nil)
+        {
+            if (condSnaps_ == nil)
+                condSnaps_ = new LookupTable(4, 8);
+
+            condSnaps_[prop] = snap;
+        }
+        else if (condSnaps_ != nil)
+            condSnaps_.removeElement(prop);
+
+        return val;
+    }
+
+    /* Get the current value of the dependency d (see conditionDeps) */
+    conditionDepValue(d)
+    {
+        switch (dataType(d))
+        {
+        case TypeProp:
+            return self.(d);
+        case TypeList:
+            return d[1].(d[2]);
+        case TypeObject:
+            return d.location;
+        default:
+            return d;
+        }
+    }
+
+    /*
+     *   Force all our conditions to be re-evaluated the next time they're
+     *   checked.  Game code can call this after changing something a
+     *   condition depends on that isn't listed in conditionDeps.
+     */
+    resetConditions() { condSnaps_ = nil; }
+
+    /*
+     *   A LookupTable of the snapshots of our conditionDeps values taken
+     *   when each condition property was last found to be nil.  For internal
+     *   use only.
+     */
+    condSnaps_ = nil
+
+    /*
+     *   Class properties: the number of condition evaluations we've
+     *   performed and skipped on objects with conditionDeps.
+     */
+    evalCount = 0
+    skipCount = 0
+;
+
 /* ------------------------------------------------------------------------ */
 /*
  *   Library global variables 
@@ -768,6 +883,21 @@ libGlobal: object
      */    
     extraDestInfo = static [ * -> unknownDest_ ]
 
+    /*
+     *   A version stamp for the state that determines which exits are listed
+     *   from a room. The exit lister uses this to decide whether it can reuse
+     *   the exit list it last displayed in the status line. Library code bumps
+     *   it (by calling exitsChanged()) whenever something likely to affect an
+     *   exit list changes, such as a door being opened or closed; game code
+     *   that changes the visibility of an exit in some other way (e.g. through
+     *   a custom isConnectorVisible condition) should call
+     *   libGlobal.exitsChanged() at the same time.
+     */
+    exitsVersion = 0
+
+    /* Note that something affecting the listing of exits has changed. */
+    exitsChanged() { ++exitsVersion; }
+
     /* 
      *   Add an item to the extraDestInfo table keyed on the source room plus
      *   the direction taken, with the value being the destination arrived at
@@ -786,8 +916,11 @@ libGlobal: object
          *   pathfinder or other code to use this information.
          */
         
-        if(extraDestInfo[[source, dirn]] not in (nil, varDest_))
-           extraDestInfo[[source, dirn]] = dest;
+        if(extraDestInfo[[source, dirn]] not in (nil, varDest_, dest))
+        {
+            extraDestInfo[[source, dirn]] = dest;
+            exitsChanged();
+        }
             
     }
     
@@ -956,6 +1089,124 @@ libGlobal: object
     altVocabLst = []   
 ;
 
+/* 
+ *   The undoManager decides when the library should create an undo savepoint,
+ *   and keeps count of the savepoints it creates. If a game sets collapseTurns
+ *   to true, consecutive turns whose actions have collapseUndo set (by default
+ *   just WAIT) are covered by a single savepoint, so that a long run of such
+ *   turns doesn't fill the interpreter's undo buffer (pushing out the
+ *   savepoints for the turns the player might actually want to undo) and a
+ *   single UNDO takes the player back to before the whole run.
+ *
+ *   This object is transient so that its counters are unaffected by UNDO and
+ *   RESTORE; undoPolicyInit resets it after a RESTORE or RESTART.
+ */
+transient undoManager: object
+    /* 
+     *   Flag: should consecutive turns with collapseUndo actions share a
+     *   single savepoint? By default we take a savepoint on every turn, so
+     *   that each UNDO takes back a single turn; game code can set this to
+     *   true to opt in to collapsing runs of such turns (including whatever
+     *   daemons did during them) into one UNDO.
+     */
+    collapseTurns = nil
+    
+    /* The maximum number of turns that can share a single savepoint. */
+    maxCollapse = 20
+    
+    /* 
+     *   Create a savepoint (if appropriate) before executing action, noting
+     *   cmdStr as the command that UNDO will take back.
+     */
+    savepointFor(action, cmdStr)
+    {
+        if(runLengths == nil)
+            reset();
+        
+        /* 
+         *   If this action and the last one both collapse into the same undo
+         *   step, don't create a new savepoint, but note that one more turn
+         *   now shares the current one.
+         */
+        if(collapseTurns && action.collapseUndo && lastCollapsible
+           && runLengths.length > 0 && runLengths[runLengths.length] < maxCollapse)
+        {
+            runLengths[runLengths.length] += 1;
+            collapsedCount++;
+            return;
+        }
+        
+        libGlobal.lastCommandForUndo = cmdStr;
+        savepoint();
+        
+        savepointCount++;
+        lastCollapsible = action.collapseUndo;
+        
+        /* Start a new run for this savepoint, discarding the oldest if need be. */
+        if(runLengths.length >= maxRuns)
+            runLengths.removeElementAt(1);
+        runLengths.append(1);
+    }
+    
+    /* 
+     *   Note that a savepoint has just been undone, and return the number of
+     *   turns that were undone with it.
+     */
+    noteUndo()
+    {
+        local n = 1;
+        
+        if(runLengths != nil && runLengths.length > 0)
+        {
+            n = runLengths[runLengths.length];
+            runLengths.removeElementAt(runLengths.length);
+        }
+        
+        undoCount++;
+        
+        /* Whatever comes next must start a new undo step. */
+        lastCollapsible = nil;
+        
+        return n;
+    }
+    
+    /* Forget our record of undo steps (after a RESTORE or RESTART). */
+    reset()
+    {
+        runLengths = new transient Vector(32);
+        lastCollapsible = nil;
+    }
+    
+    /* 
+     *   Was the last savepoint created for an action that allows subsequent
+     *   turns to share it?
+     */
+    lastCollapsible = nil
+    
+    /* 
+     *   A Vector holding, for each of the most recent savepoints, the number of
+     *   turns that share it.
+     */
+    runLengths = nil
+    
+    /* The number of savepoints we keep track of in runLengths. */
+    maxRuns = 100
+    
+    /* 
+     *   Counters for profiling: the number of savepoints created, the number of
+     *   turns that shared an existing savepoint instead of creating a new one,
+     *   and the number of savepoints undone this session.
+     */
+    savepointCount = 0
+    collapsedCount = 0
+    undoCount = 0
+;
+
+/* Reset the undoManager at the start of play and after a RESTORE. */
+undoPolicyInit: InitObject, PostRestoreObject
+    execute() { undoManager.reset(); }
+;
+
 
 
 /* object representing an unknown destination */
@@ -1018,6 +1269,17 @@ finishGameMsg(msg, extra)
 {
     local lst;
 
+#ifdef __DEBUG
+    /* 
+     *   if the game ends during a soak test (see debug.t), stop the soak test
+     *   rather than waiting for the player to choose what to do next 
+     */
+    if (soakTest.running)
+    {
+        soakTest.gameOver = true;
+        throw new SoakGameOverSignal();
+    }
+#endif
     
     /*
      *   Explicitly run any final score notification now.  This will ensure
@@ -1670,6 +1932,13 @@ isListSubset(a, b)
  */
 findMatchingTopic(voc, cls = Topic)
 {
+    /* 
+     *   If we're looking for a kind of Mentionable, we can use the vocabIndex;
+     *   otherwise we have to search every instance of cls.
+     */
+    if(cls.ofKind(Mentionable))
+        return vocabIndex.find(voc, cls);
+    
     for(local cur = firstObj(cls); cur != nil; cur = nextObj(cur, cls))
     {
         if(cur.vocab == voc)
@@ -1679,6 +1948,142 @@ findMatchingTopic(voc, cls = Topic)
     return nil;
 }
 
+/* 
+ *   The vocabIndex maintains a table of Mentionables keyed on their vocab
+ *   strings, so that findMatchingTopic() can find an existing Topic (or other
+ *   Mentionable) with a given vocab without searching through every object in
+ *   the game. The table is built the first time it's needed and thereafter kept
+ *   up to date by Mentionable.initVocab(), which is called whenever a new
+ *   Mentionable is created or an existing one's vocab is changed through
+ *   replaceVocab() or addVocab().
+ *
+ *   The index only refers to each Mentionable weakly, so it doesn't keep
+ *   dynamically created Topics and Things alive once nothing else refers to
+ *   them. Game code that assigns a new value to an object's vocab property
+ *   directly, rather than through replaceVocab(), should call noteVocab() on
+ *   that object afterwards (or the object may not be found under its new
+ *   vocab); game code that no longer wants an object to be found can call
+ *   forget().
+ */
+vocabIndex: object
+    /* 
+     *   Find a Mentionable of class cls whose vocab is voc, or return nil if
+     *   there isn't one. If there's more than one, we return the one that
+     *   was indexed first.
+     */
+    find(voc, cls = Topic)
+    {
+        if(vocabTab == nil)
+            buildIndex();
+        
+        local tab = vocabTab[voc];
+        
+        if(tab == nil)
+            return nil;
+        
+        /* 
+         *   If everything indexed under voc has been garbage-collected, we
+         *   can drop the entry altogether.
+         */
+        if(tab.getEntryCount() == 0)
+        {
+            vocabTab.removeElement(voc);
+            return nil;
+        }
+        
+        local best = nil;
+        
+        tab.forEachAssoc(function(key, o) {
+            if(o.vocab == voc && o.ofKind(cls)
+               && (best == nil || key < best.vocabIndexKey_))
+                best = o;
+        });
+        
+        return best;
+    }
+    
+    /* 
+     *   Note the current vocab of obj, removing it from the entry for its
+     *   previous vocab if this has changed. We don't do anything until the
+     *   table has been built, since building it will pick up obj anyway.
+     */
+    noteVocab(obj)
+    {
+        if(vocabTab == nil)
+            return;
+        
+        local voc = obj.vocab;
+        
+        if(obj.vocabIndexVoc_ == voc && voc != nil)
+            return;
+        
+        forget(obj);        
+        addEntry(obj, voc);
+    }
+    
+    /* Remove obj from our table, if it's there. */
+    forget(obj)
+    {
+        local oldVoc = obj.vocabIndexVoc_;
+        
+        if(oldVoc == nil || vocabTab == nil)
+            return;
+        
+        local tab = vocabTab[oldVoc];
+        
+        if(tab != nil)
+        {
+            tab.removeElement(obj.vocabIndexKey_);
+            
+            if(tab.getEntryCount() == 0)
+                vocabTab.removeElement(oldVoc);
+        }
+        
+        obj.vocabIndexVoc_ = nil;
+        obj.vocabIndexKey_ = nil;
+    }
+    
+    /* Build our table from every Mentionable in the game. */
+    buildIndex()
+    {
+        vocabTab = new LookupTable(256, 512);
+        
+        for(local cur = firstObj(Mentionable); cur != nil; 
+            cur = nextObj(cur, Mentionable))
+            addEntry(cur, cur.vocab);
+    }
+    
+    /* 
+     *   Service routine: add obj to our table under voc, giving it the next
+     *   key in sequence.
+     */
+    addEntry(obj, voc)
+    {
+        if(voc == nil)
+            return;
+        
+        local tab = vocabTab[voc];
+        
+        if(tab == nil)
+            vocabTab[voc] = tab = new WeakRefLookupTable(4, 8);
+        
+        tab[++lastKey] = obj;
+        obj.vocabIndexVoc_ = voc;
+        obj.vocabIndexKey_ = lastKey;
+    }
+    
+    /* 
+     *   A LookupTable mapping vocab strings to WeakRefLookupTables, each of
+     *   which maps the keys we've assigned to the Mentionables indexed under
+     *   that vocab string. Since the Mentionables are the values of those
+     *   tables, they're only referenced weakly.
+     */
+    vocabTab = nil
+    
+    /* The last key we assigned to a Mentionable */
+    lastKey = 0
+;
+
 /* 
  *   Set the player character to another actor. If the optional second parameter
  *   is supplied, it sets the person of the player character; otherwise it
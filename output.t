@@ -586,6 +586,10 @@ transient mainOutputStream: OutputStream
     {
         /* write the text to the console */
         aioSay(txt);
+        
+        /* pass it on to the transcript recorder if it's recording */
+        if(transcriptRecorder.isRecording)
+            transcriptRecorder.noteOutput(txt);
     }
 ;
 
@@ -1774,6 +1778,8 @@ class LogConsole: OutputStream
         addOutputFilter(new transient ParagraphManager());
         addOutputFilter(styleTagFilter);
 
+        /* let the log flush manager know we need flushing */
+        logFlushManager.register(self);
     }
 
     /* 
@@ -1783,6 +1789,10 @@ class LogConsole: OutputStream
      */
     closeConsole()
     {
+        /* write out anything still in our buffer */
+        flushBuffer();
+        logFlushManager.unregister(self);
+        
         /* close our underlying system console */
         logConsoleClose(handle_);
 
@@ -1794,13 +1804,400 @@ class LogConsole: OutputStream
         handle_ = nil;
     }
 
-    /* low-level stream writer - write to our system log console */
-    writeFromStream(txt) { logConsoleSay(handle_, txt); }
+    /* 
+     *   Low-level stream writer. Rather than passing each fragment of text
+     *   straight to our system log console, we collect it in a buffer and
+     *   write it out in larger chunks, since a session's output arrives in a
+     *   great many small fragments and writing each one separately makes
+     *   logging far more expensive than it needs to be.
+     */
+    writeFromStream(txt) 
+    { 
+        /* if we're not buffering, write the text straight through */
+        if(bufferSize == 0)
+        {
+            logConsoleSay(handle_, txt);
+            return;
+        }
+        
+        if(buffer_ == nil)
+            buffer_ = new StringBuffer(bufferSize + 256);
+        
+        buffer_.append(txt);
+        
+        /* if the buffer's full, write it out */
+        if(buffer_.length() >= bufferSize)
+            flushBuffer();
+    }
+    
+    /* Write out and empty our buffer. */
+    flushBuffer()
+    {
+        if(buffer_ != nil && buffer_.length() > 0 && handle_ != nil)
+        {
+            logConsoleSay(handle_, toString(buffer_));
+            buffer_.deleteChars(1);
+            flushCount++;
+        }
+    }
+    
+    /* 
+     *   The number of characters of output we'll buffer before writing them
+     *   to the system log console. Set this to 0 to write each fragment of
+     *   text as soon as it's produced.
+     */
+    bufferSize = 4096
+    
+    /* 
+     *   Flag: do we want to flush our buffer at the end of each turn (just
+     *   before the next command prompt)? If this is nil we only write out
+     *   our buffer when it fills up, when we're closed, or when the program
+     *   exits.
+     */
+    flushEachTurn = true
+    
+    /* The number of times we've written our buffer to the system console */
+    flushCount = 0
+
+    /* our output buffer */
+    buffer_ = nil
 
     /* our system log console handle */
     handle_ = nil
 ;
 
+/* 
+ *   The logFlushManager keeps track of every open LogConsole (and the
+ *   transcriptRecorder) so that their buffers can be flushed at the end of
+ *   each turn and when the program exits. It's transient since the
+ *   consoles it tracks are part of the interpreter session rather than the
+ *   game state.
+ */
+transient logFlushManager: object
+    /* Add con to the list of consoles we look after */
+    register(con)
+    {
+        if(consoles == nil)
+            consoles = new Vector(4);
+        
+        consoles.appendUnique(con);
+    }
+    
+    /* Remove con from our list of consoles */
+    unregister(con)
+    {
+        if(consoles != nil)
+            consoles.removeElement(con);
+    }
+    
+    /* 
+     *   Flush the buffers of all our consoles. If turnEnd is true we're
+     *   being called at the end of a turn, so we only flush those consoles
+     *   that want to be flushed every turn.
+     */
+    flushAll(turnEnd?)
+    {
+        foreach(local con in valToList(consoles))
+        {
+            if(!turnEnd || con.flushEachTurn)
+                con.flushBuffer();
+        }
+    }
+    
+    /* The list of consoles we're looking after */
+    consoles = nil
+    
+    /* 
+     *   Flag: have we registered our exit handler? This has to be done just
+     *   once per interpreter session, not once per RESTART.
+     */
+    exitHandlerSet = nil
+;
+
+/* 
+ *   Set up the per-turn and program-exit flushing of buffered log output.
+ */
+logFlushInit: InitObject
+    execute()
+    {
+        if(!logFlushManager.exitHandlerSet)
+        {
+            mainAtExit.addHandler(new function()
+            {
+                transcriptRecorder.stop();
+                logFlushManager.flushAll(nil);
+            });
+            logFlushManager.exitHandlerSet = true;
+        }
+        
+        if(defined(PromptDaemon) && new PromptDaemon(self, &turnFlush));
+    }
+    
+    /* Flush any consoles that want flushing at the end of each turn */
+    turnFlush() { logFlushManager.flushAll(true); }
+;
+
+/* ------------------------------------------------------------------------ */
+/*
+ *   Structured transcript recorder. While recording, this writes a compact
+ *   record of each turn to a text file: one line per command, giving the
+ *   turn number, the command as typed, and the output that followed it
+ *   (after all the output filters have been applied), separated by tabs.
+ *   Tabs, newlines and backslashes within the command and output are
+ *   escaped as \t, \n and \\, so each record is always a single line. Any
+ *   output produced before the first command is recorded with an empty
+ *   command.
+ *
+ *   Records are buffered and written out in chunks, just like LogConsole
+ *   output. A transcript made this way can be replayed with replay(), which
+ *   runs through its commands in order.
+ */
+transient transcriptRecorder: object
+    /* 
+     *   Start recording to the file fname. Returns true on success or nil if
+     *   the file couldn't be opened.
+     */
+    start(fname)
+    {
+        if(file_ != nil)
+            stop();
+        
+        try
+        {
+            file_ = File.openTextFile(fname, FileAccessWrite, 'utf-8');
+            file_.writeFile(header + '\n');
+        }
+        catch(FileException fe)
+        {
+            file_ = nil;
+            return nil;
+        }
+        
+        cmd_ = nil;
+        turn_ = libGlobal.totalTurns;
+        out_ = new StringBuffer(1024);
+        buffer_ = new StringBuffer(bufferSize + 256);
+        logFlushManager.register(self);
+        return true;
+    }
+    
+    /* Stop recording, writing out the last record and closing the file. */
+    stop()
+    {
+        if(file_ == nil)
+            return;
+        
+        endRecord();
+        flushBuffer();
+        logFlushManager.unregister(self);
+        
+        try
+        {
+            file_.closeFile();
+        }
+        catch(FileException fe)
+        {
+            /* there's nothing useful we can do about this */
+        }
+        
+        file_ = nil;
+    }
+    
+    /* Are we currently recording? */
+    isRecording = (file_ != nil)
+    
+    /* 
+     *   Note that the player has entered a new command; this ends the record
+     *   for the previous command.
+     */
+    noteCommand(str)
+    {
+        endRecord();
+        cmd_ = str;
+        turn_ = libGlobal.totalTurns;
+    }
+    
+    /* Note some text that's been written to the main output stream */
+    noteOutput(txt)
+    {
+        out_.append(txt);
+    }
+    
+    /* Add the record for the current command to our buffer. */
+    endRecord()
+    {
+        if(cmd_ == nil && out_.length() == 0)
+            return;
+        
+        buffer_.append(toString(turn_) + '\t' + escape(cmd_ ?? '') + '\t'
+                       + escape(toString(out_)) + '\n');
+        
+        out_.deleteChars(1);
+        cmd_ = nil;
+        recordCount++;
+        
+        if(buffer_.length() >= bufferSize)
+            flushBuffer();
+    }
+    
+    /* Write out and empty our buffer */
+    flushBuffer()
+    {
+        if(file_ != nil && buffer_.length() > 0)
+        {
+            try
+            {
+                file_.writeFile(toString(buffer_));
+            }
+            catch(FileException fe)
+            {
+                /* there's nothing useful we can do about this */
+            }
+            
+            buffer_.deleteChars(1);
+        }
+    }
+    
+    /* Escape tabs, newlines and backslashes in str */
+    escape(str)
+    {
+        return str.findReplace(escapePat, 
+            {m: m == '\t' ? '\\t' : m == '\n' ? '\\n' : '\\\\'}, ReplaceAll);
+    }
+    
+    /* Reverse the escaping performed by escape() */
+    unescape(str)
+    {
+        return str.findReplace(unescapePat, 
+            {m: m == '\\t' ? '\t' : m == '\\n' ? '\n' : m.substr(2)}, 
+            ReplaceAll);
+    }
+    
+    escapePat = static new RexPattern('<tab|linefeed|backslash>')
+    unescapePat = static new RexPattern('<backslash>.')
+    
+    /* 
+     *   Read the transcript in fname, returning a list of [turn, command,
+     *   output] lists, one for each record; returns nil if the file can't be
+     *   read or isn't a transcript.
+     */
+    readTranscript(fname)
+    {
+        local f, line, vec = new Vector(64);
+        
+        try
+        {
+            f = File.openTextFile(fname, FileAccessRead, 'utf-8');
+            
+            line = f.readFile();
+            if(line == nil || !line.startsWith(header))
+            {
+                f.closeFile();
+                return nil;
+            }
+            
+            while((line = f.readFile()) != nil)
+            {
+                local fields = line;
+                
+                if(fields.endsWith('\n'))
+                    fields = fields.substr(1, fields.length - 1);
+                
+                fields = fields.split('\t', 3);
+                
+                if(fields.length == 3)
+                    vec.append([toInteger(fields[1]), unescape(fields[2]),
+                               unescape(fields[3])]);
+            }
+            
+            f.closeFile();
+        }
+        catch(FileException fe)
+        {
+            return nil;
+        }
+        
+        return vec.toList();
+    }
+    
+    /* 
+     *   Replay the commands recorded in the transcript fname, just as if the
+     *   player had typed them. Returns nil if the transcript couldn't be
+     *   read.
+     */
+    replay(fname)
+    {
+        local recs = readTranscript(fname);
+        
+        if(recs == nil)
+            return nil;
+        
+        foreach(local rec in recs)
+        {
+            local txt = rec[2];
+            
+            if(txt == '')
+                continue;
+            
+            "<.p>";
+            "<.inputline>";
+            DMsg(command prompt, '>');
+            "<<txt>><./inputline>\n";
+            
+            try
+            {
+                txt = StringPreParser.runAll(txt, Parser.rmcType());
+                
+                if(txt != nil)
+                    Parser.parse(txt);
+            }
+            catch(TerminateCommandException tce)
+            {
+            }
+            
+            statusLine.showStatusLine();
+        }
+        
+        return true;
+    }
+    
+    /* The first line of every transcript file */
+    header = '#TRANSCRIPT 1'
+    
+    /* The number of characters of records we buffer before writing them */
+    bufferSize = 8192
+    
+    /* We flush our buffer every turn when logFlushManager asks us to */
+    flushEachTurn = true
+    
+    /* The number of records we've written */
+    recordCount = 0
+    
+    /* Our file, the current command, turn and output, and our buffer */
+    file_ = nil
+    cmd_ = nil
+    turn_ = 0
+    out_ = nil
+    buffer_ = nil
+;
+
+/* 
+ *   Pass each command the player types to the transcriptRecorder. We run
+ *   before any other StringPreParser so that we see the command exactly as
+ *   it was typed.
+ */
+transcriptPreParser: StringPreParser
+    runOrder = 1
+    
+    doParsing(str, which)
+    {
+        if(transcriptRecorder.isRecording)
+            transcriptRecorder.noteCommand(str);
+        
+        return str;
+    }
+;
+
 /* ------------------------------------------------------------------------ */
 /*
  *   Output stream window.
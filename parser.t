@@ -220,9 +220,16 @@ class Parser: object
             /* run the command tokenizer over the input string */
             toks = cmdTokenizer.tokenize(str);
             
-            /* Dispose of any unwanted terminal punctuation */
-            while(toks.length > 0 && getTokType(toks[toks.length]) == tokPunct)
-                toks = toks.removeElementAt(toks.length);
+            /* 
+             *   Dispose of any unwanted terminal punctuation, trimming the
+             *   list just once however many punctuation tokens there are.
+             */
+            local n = toks.length;
+            while(n > 0 && getTokType(toks[n]) == tokPunct)
+                --n;
+            
+            if(n < toks.length)
+                toks = toks.sublist(1, n);
             
         }
         catch (TokErrorNoMatch err)
@@ -409,8 +416,7 @@ class Parser: object
                             topicPhrase, toks, cmdDict,
                             { p: new Command(SayAction, p) });
                         
-                        libGlobal.lastCommandForUndo = str;
-                        savepoint();
+                        undoManager.savepointFor(SayAction, str);
                     }
                     /* 
                      *   If the player char is not in conversation with anyone,
@@ -876,22 +882,47 @@ class CommandList: object
             local prod = args[1], toks = args[2], dict = args[3],
                 wrapper = args[4];
 
-            /* parse the token list, and map the list to Command objects  */
-            cmdLst = prod.parseTokens(toks, dict).mapAll(wrapper);
+            /* parse the token list */
+            local trees = prod.parseTokens(toks, dict);
+            treeCount = trees.length();
+            
+            /* 
+             *   If we're not building lazily, map the whole list to Command
+             *   objects and sort it in priority order up front.
+             */
+            if (!lazyBuild)
+            {
+                cmdLst = Command.sortList(trees.mapAll(wrapper));
+                builtCount = treeCount;
+            }
             
-            /* sort in priority order */
-            cmdLst = Command.sortList(cmdLst);
+            /* 
+             *   Otherwise pair each parse tree with the upper bound on the
+             *   priority of any Command built from it, and sort the trees
+             *   in descending order of bound; trees we can't bound go
+             *   first, since we'll have to build them to know where they
+             *   belong.
+             */
+            else
+            {
+                pending_ = trees.mapAll(
+                    { t: [t, Command.priorityBound(t) ?? maxPriorityBound] })
+                    .sort(SortDesc, {a, b: a[2] - b[2]});
+                
+                cmdLst = [];
+            }
             
             /* 
              *   Go through the list, looking for an item with noun phrases we
              *   can resolve.  Take the first item that we can properly
              *   resolve.  
              */
-            foreach (local c in cmdLst)
+            for (local c = nextCmd(wrapper) ; c != nil ; c = nextCmd(wrapper))
             {
                 try
                 {                    
                     /* resolve this phrase */
+                    ++resolvedCount;
                     c.resolveNouns();
                     
                     /* success - take this as the result; look no further */
@@ -937,6 +968,21 @@ class CommandList: object
                         curable = c;
                 }
             }
+            
+            /* 
+             *   Put any Commands we built but didn't need to try at the end
+             *   of our list, in priority order.
+             */
+            if (built_ != nil)
+            {
+                cmdLst += built_.toList();
+                built_ = nil;
+            }
+            
+            /* note our counts for this input */
+            CommandList.totalTrees += treeCount;
+            CommandList.totalBuilt += builtCount;
+            CommandList.totalResolved += resolvedCount;
         }
         else if (args.matchProto([Command]))
         {
@@ -954,8 +1000,115 @@ class CommandList: object
             throw new ArgumentMismatchError();
     }
 
-    /* number of parsings in the list */
-    length() { return cmdLst.length(); }
+    /* 
+     *   Get the next Command to try resolving, in priority order, or nil if
+     *   there are none left.  When we're building lazily, we only build as
+     *   many Commands from our pending parse trees as we need to be sure
+     *   that the best one we've built so far outranks every tree we haven't
+     *   built yet.  In either case we add the Command we return to cmdLst,
+     *   so that cmdLst always holds the Commands we've tried, in order.
+     */
+    nextCmd(wrapper)
+    {
+        local c;
+        
+        if (!lazyBuild)
+        {
+            if (cmdLst.length() <= tryIdx_)
+                return nil;
+            
+            return cmdLst[++tryIdx_];
+        }
+        
+        if (built_ == nil)
+            built_ = new Vector(8);
+        
+        /* 
+         *   Build Commands until the best one we have can't be outranked by
+         *   any tree still pending.
+         */
+        while (pendIdx_ < pending_.length()
+               && (built_.length() == 0
+                   || built_[1].priority < pending_[pendIdx_ + 1][2]))
+        {
+            c = (wrapper)(pending_[++pendIdx_][1]);
+            ++builtCount;
+            
+            /* ignore commands whose predicates are inactive */
+            if (!c.predActive)
+                continue;
+            
+            /* insert it in built_ after any commands of equal priority */
+            c.fixPriority();
+            local i = built_.indexWhich({x: x.priority < c.priority});
+            if (i == nil)
+                built_.append(c);
+            else
+                built_.insertAt(i, c);
+        }
+        
+        if (built_.length() == 0)
+            return nil;
+        
+        c = built_[1];
+        built_.removeElementAt(1);
+        cmdLst += c;
+        
+        return c;
+    }
+    
+    /*
+     *   Flag: build and resolve Commands lazily, in priority order, rather
+     *   than building a Command for every parse tree and sorting the lot
+     *   before we start resolving them.  Highly ambiguous input can produce
+     *   hundreds of parse trees, almost all of which are discarded once the
+     *   first one resolves.  This relies on Command.priorityBound() being
+     *   consistent with Command.calcPriority(), so a game that changes the
+     *   latter without the former should set this to nil.
+     */
+    lazyBuild = true
+    
+    /* the priority bound we use for parse trees we can't bound */
+    maxPriorityBound = 0x7FFFFFFF
+    
+    /* 
+     *   The parse trees we haven't yet built Commands from, each paired with
+     *   the upper bound on its priority, in descending order of bound.
+     */
+    pending_ = []
+    
+    /* 
+     *   The Commands we've built but not yet tried, in descending order of
+     *   priority.
+     */
+    built_ = nil
+    
+    /* the index of the last pending parse tree we built a Command from */
+    pendIdx_ = 0
+    
+    /* the index of the last Command we tried when not building lazily */
+    tryIdx_ = 0
+    
+    /* 
+     *   The number of parse trees our input produced, the number of Commands
+     *   we built from them, and the number of those we tried to resolve.
+     */
+    treeCount = 0
+    builtCount = 0
+    resolvedCount = 0
+    
+    /* running totals of the above over all CommandLists */
+    totalTrees = 0
+    totalBuilt = 0
+    totalResolved = 0
+
+    /* 
+     *   The number of parsings in the list.  If we stopped resolving before
+     *   building Commands from all our parse trees, this counts the unbuilt
+     *   trees as well, some of which might have proved to be for inactive
+     *   predicates.
+     */
+    length() { return cmdLst.length() + pending_.length() - pendIdx_; }
 
     /*
      *   Accept a curable resolution as the actual resolution.  If we don't
@@ -1289,6 +1442,21 @@ class Distinguisher: object
      */
     equal(a, b) { return nil; }
 
+    /*
+     *   Flag: does this distinguisher define distKey()?  If so, apply()
+     *   partitions objects in a single pass by hashing their keys rather
+     *   than comparing every pair of objects with equal().
+     */
+    keyed = nil
+
+    /*
+     *   Get the key by which this distinguisher partitions obj.  Two objects
+     *   must have the same key (by LookupTable comparison) exactly when
+     *   equal() would say they're equivalent.  This is only used if keyed is
+     *   true.
+     */
+    distKey(obj) { return nil; }
+
     /* 
      *   Is this distinguisher applicable to the given object?  Some
      *   distinguishers can only apply to certain objects.  For example, a
@@ -1311,6 +1479,37 @@ class Distinguisher: object
 
         /* set up the list of applicable objects */
         r.appliesTo = lst.subset({ obj: appliesTo(obj) });
+        
+        /* if we have a key function, partition by key */
+        if (keyed)
+        {
+            local keyTab = new LookupTable(16, 32);
+            
+            /* 
+             *   Run through the items in the same (reverse) order as the
+             *   pairwise method below, so that each partition lists its
+             *   objects in the same order.  A nil key can't be used in a
+             *   LookupTable, so we file objects with nil keys under self.
+             */
+            for (local i = r.appliesTo.length() ; i > 0 ; --i)
+            {
+                local obj = r.appliesTo[i];
+                local key = distKey(obj) ?? self;
+                local sv = keyTab[key];
+                
+                if (sv == nil)
+                {
+                    sv = new Vector(10);
+                    keyTab[key] = sv;
+                    r.partitioned.append(sv);
+                }
+                
+                sv.append(obj);
+                r.partTab[obj] = sv;
+            }
+            
+            return r;
+        }
 
         /* make a to-do vector, starting with all applicable items */
         local toDo = new Vector(10, r.appliesTo);
@@ -1326,6 +1525,7 @@ class Distinguisher: object
 
             /* start the partition with the current object */
             sv.append(obj);
+            r.partTab[obj] = sv;
 
             /* add the new partition to the partition list */
             r.partitioned.append(sv);
@@ -1339,6 +1539,7 @@ class Distinguisher: object
                 {
                     /* it's equivalent to obj, so add it to obj's partition */
                     sv.append(obj2);
+                    r.partTab[obj2] = sv;
 
                     /* it's been processed; remove it from the to-do list */
                     toDo.removeElementAt(i);
@@ -1406,7 +1607,7 @@ class Distinguisher: object
             local obj = objs.pop();
 
             /* get the subset of dist results that apply to this object */
-            local ores = dres.subset({ r: r.appliesTo.indexOf(obj) != nil });
+            local ores = dres.subset({ r: r.partTab[obj] != nil });
 
             /*
              *   What we're after is the minimum set of distinguishers that
@@ -1546,12 +1747,15 @@ class DistResult: object
 
         /* set up a vector for the partition list */
         partitioned = new Vector(10);
+        
+        /* set up the table mapping each object to its partition */
+        partTab = new LookupTable(16, 32);
     }
 
     /* get the partition in which 'obj' appears */
     partition(obj)
     {
-        return partitioned.valWhich({ p: p.indexOf(obj) != nil });
+        return partTab[obj];
     }
 
     /* get the size of the partition in which 'obj' appears */
@@ -1570,6 +1774,12 @@ class DistResult: object
      *   each object in a sublist appears in appliesTo.  
      */
     partitioned = []
+    
+    /* 
+     *   A LookupTable mapping each object in appliesTo to the sublist of
+     *   partitioned in which it appears. 
+     */
+    partTab = nil
 
     /* the Distinguisher that these results come from */
     distinguisher = nil
@@ -1598,6 +1808,8 @@ nameDistinguisher: Distinguisher
 disambigNameDistinguisher: Distinguisher
     sortOrder = Distinguisher.disambiguating ? 50: 100 // EXPERIMENT to try prioritizing the disambigNameDistinguisher
     equal(a, b) { return a.disambigName == b.disambigName; }
+    keyed = true
+    distKey(obj) { return obj.disambigName; }
 ;
 
 /*
@@ -1611,6 +1823,8 @@ class StateDistinguisher: Distinguisher
 
     /* we distinguish based on each object's current value for the state */
     equal(a, b) { return a.(state.stateProp) == b.(state.stateProp); }
+    keyed = true
+    distKey(obj) { return obj.(state.stateProp); }
 
     /* we only apply to objects that have our state variable */
     appliesTo(obj) { return state.appliesTo(obj); }
@@ -1644,6 +1858,8 @@ ownerDistinguisher: Distinguisher
     sortOrder = 400
     appliesTo(obj) { return obj.nominalOwner() != nil; }
     equal(a, b) { return a.nominalOwner() == b.nominalOwner(); }
+    keyed = true
+    distKey(obj) { return obj.nominalOwner(); }
 ;
 
 /*
@@ -1653,6 +1869,8 @@ ownerDistinguisher: Distinguisher
 locationDistinguisher: Distinguisher
     sortOrder = 500
     equal(a, b) { return a.location == b.location; }
+    keyed = true
+    distKey(obj) { return obj.location; }
 ;
 
 /*
@@ -1673,6 +1891,12 @@ contentsDistinguisher: Distinguisher
         local ac = a.nominalContents(), bc = b.nominalContents();
         return (ac != nil ? ac.name : nil) == (bc != nil ? bc.name : nil);
     }
+    keyed = true
+    distKey(obj)
+    {
+        local c = obj.nominalContents();
+        return (c != nil ? c.name : nil);
+    }
 ;
     
 
@@ -1691,6 +1915,8 @@ class NounPhrase: object
     /* create */
     construct(parent, prod)
     {
+        NoteAlloc(NounPhrase);
+        
         /* 
          *   remember the parent NounPhrase and the grammar production
          *   match object that's the source of the noun phrase
@@ -1704,6 +1930,7 @@ class NounPhrase: object
     {
         /* create a new object with my same property values */
         local cl = createClone();
+        NoteAlloc(NounPhrase);
 
         /* make safe copies of any vectors */
         foreach (local p in cl.getPropList())
@@ -1918,7 +2145,8 @@ class NounPhrase: object
             return;
 
         /* wrap each item in an NPMatch object and add it to the vector */
-        vec.appendAll(valToList(lst).mapAll({ obj: new NPMatch(self, obj, match) }));
+        foreach (local obj in valToList(lst))
+            vec.append(new NPMatch(self, obj, match));
     }
 
     /*
@@ -1928,43 +2156,44 @@ class NounPhrase: object
     matchNameScope(cmd, scope)
     {
         /* set up a vector for the results */
-        local v = new Vector(32);
+        local v = new Vector(16);
+        
+        /* the strongest match we've found so far */
+        local best = 0;
         
         /*
          *   Run through the scope list and ask each object if it matches
-         *   the noun phrase.  Keep the ones that match.  
+         *   the noun phrase.  We only keep the matches that have the
+         *   maximum strength of the list, so rather than wrapping every
+         *   match in an NPMatch and then discarding the weaker ones, we
+         *   keep track of the strongest match as we go, and start the list
+         *   again whenever we find a stronger one.  
          */
         foreach (local obj in scope)
         {
             /* ask this object if it matches */
             local match = obj.matchName(tokens);
             
-            /* if it matches, include it in the results */
-            if (match)
+            /* if it doesn't match, skip it */
+            if (!match)
+                continue;
+            
+            /* if it's stronger than anything so far, start again with it */
+            local strength = NPMatch.strengthOf(match);
+            if (strength > best)
+            {
+                v.setLength(0);
+                best = strength;
+            }
+            
+            /* if it's as strong as the strongest, include it */
+            if (strength == best)
                 v.append(new NPMatch(self, obj, match));
         }
 
-        /*
-         *   Now narrow the list according to the match strength.  Only
-         *   keep the matches that have the maximum strength of the list.
-         */
-        if (v.length() > 0)
-        {
-            /* sort in descending order of strength */
-            v.sort(SortDesc, { a, b: a.strength - b.strength });
-
-            /* 
-             *   discard everything that doesn't match the highest strength
-             *   (which is the first element's strength, since we've sorted
-             *   in descending order) 
-             */
-            v = v.subset({ a: a.strength == v[1].strength });
-        }
-        else
-        {
-            /* the list is empty - complain about it */
+        /* if the list is empty, complain about it */
+        if (v.length() == 0)
             throw new UnmatchedNounError(cmd, self);
-        }
 
         /* return the list */
         return v;
@@ -3281,6 +3510,8 @@ class NumericObject: object
 class NPMatch: object
     construct(np, obj, match)
     {
+        NoteAlloc(NPMatch);
+        
         /* save the NounPhrase, the object we matched, and the match flags */
         self.np = np;
         self.obj = obj;
@@ -3313,8 +3544,13 @@ class NPMatch: object
          *   nouns are equivalent.  So the strength value is the match
          *   value with any plural flag replaced by the noun flag. 
          */
-        self.strength = (match & ~MatchPlural)
-            | (match & MatchPlural ? MatchNoun : 0);
+        self.strength = strengthOf(match);
+    }
+    
+    /* the match strength corresponding to the given MatchXxx flags */
+    strengthOf(match)
+    {
+        return (match & ~MatchPlural) | (match & MatchPlural ? MatchNoun : 0);
     }
 
     /* the NounPhrase we matched */
@@ -3638,6 +3874,30 @@ class Production: object
         /* didn't find it */
         return nil;
     }
+    
+    /*
+     *   Find the highest priority of any VerbProduction in this subtree,
+     *   or nil if there isn't one.  CommandList uses this to rank parse
+     *   trees before building Commands from them.
+     */
+    maxPredPriority()
+    {
+        local best = (ofKind(VerbProduction) ? priority : nil);
+        
+        /* recursively scan my children */
+        for (local gi = grammarInfo(), local i = 2, local len = gi.length() ;
+             i <= len ; ++i)
+        {
+            if (dataType(gi[i]) != TypeObject)
+                continue;
+            
+            local pri = gi[i].maxPredPriority();
+            if (pri != nil && (best == nil || pri > best))
+                best = pri;
+        }
+        
+        return best;
+    }
 ;
 
 /*
@@ -5117,7 +5377,7 @@ class NotUnderstoodError: ParseError
         local txt = getTokVal(toks[idx]);
 
         /* look up the word in the action vocabulary table */
-        local w = actionDictionary.wordToAction[txt];
+        local w = actionDictionary.getWordToAction()[txt];
         if (w != nil)
         {
             /* get the highest spelling priority of the matching actions */
@@ -5129,7 +5389,7 @@ class NotUnderstoodError: ParseError
              *   candidate is 'up', look for words like 'pick', 'go', or
              *   'look' that occur in the same verb rules with 'up'.) 
              */
-            local xlst = actionDictionary.xwords[txt] - txt;
+            local xlst = actionDictionary.getXwords()[txt] - txt;
             local xbonus = (toks.indexWhich(
                 { t: xlst.indexOf(getTokVal(t)) != nil }) != nil);
 
@@ -1050,6 +1050,18 @@ commLink: Special
  *   list of in-scope objects satisfying some condition.
  */
 class ScopeList: object
+    /* 
+     *   Take our working vector and table from the scopeListPool, so that
+     *   building a scope list doesn't allocate new ones each time.
+     */
+    construct()
+    {
+        NoteAlloc(ScopeList);
+        
+        vec_ = scopeListPool.takeVector();
+        status_ = scopeListPool.takeTable();
+    }
+    
     /*
      *   Add an object and its contents to the scope. 
      */
@@ -1130,10 +1142,16 @@ class ScopeList: object
         status_[obj] = 1;
     }
 
-    /* "close" the scope list - this converts the vector to a list */
+    /* 
+     *   "close" the scope list - this converts the vector to a list, and
+     *   hands our working vector and table back to the scopeListPool
+     */
     close()
     {
-        vec_ = vec_.toList();
+        local v = vec_;
+        
+        vec_ = v.toList();
+        scopeListPool.release(v, status_, vec_);
         status_ = nil;
     }
 
@@ -1180,6 +1198,88 @@ class ScopeList: object
     status_ = perInstance(new LookupTable(64, 128))
 ;
 
+/* 
+ *   A pool of the working vectors and tables used to build ScopeLists. Scope
+ *   lists are built many times each turn and each is closed as soon as it's
+ *   built, so rather than leaving a fresh Vector and LookupTable for the
+ *   garbage collector every time, we empty them and keep them for the next
+ *   one. We keep a small stack of each in case a scope list is built while
+ *   another one is being built.
+ *
+ *   The pool and its contents are transient, so that emptying and refilling
+ *   them doesn't add to the undo log.
+ */
+transient scopeListPool: object
+    /* Get an empty working vector */
+    takeVector()
+    {
+        if(vecs_ == nil)
+            reset();
+        
+        if(vecs_.length() > 0)
+        {
+            hits++;
+            return vecs_.pop();
+        }
+        
+        misses++;
+        return new transient Vector(50);
+    }
+    
+    /* Get an empty status table */
+    takeTable()
+    {
+        if(tabs_ == nil)
+            reset();
+        
+        if(tabs_.length() > 0)
+            return tabs_.pop();
+        
+        return new transient LookupTable(64, 128);
+    }
+    
+    /* 
+     *   Empty vec and tab and return them to the pool. Every key in tab is
+     *   an element of lst, the list of objects in scope.
+     */
+    release(vec, tab, lst)
+    {
+        if(vecs_ == nil)
+            reset();
+        
+        if(vecs_.length() >= maxPool || !vec.ofKind(Vector) || tab == nil)
+            return;
+        
+        vec.setLength(0);
+        foreach(local obj in lst)
+            tab.removeElement(obj);
+        
+        vecs_.append(vec);
+        tabs_.append(tab);
+    }
+    
+    /* Start with an empty pool */
+    reset()
+    {
+        vecs_ = new transient Vector(maxPool);
+        tabs_ = new transient Vector(maxPool);
+    }
+    
+    /* The largest number of vectors (and tables) we keep. */
+    maxPool = 4
+    
+    /* Our spare vectors and tables */
+    vecs_ = nil
+    tabs_ = nil
+    
+    /* 
+     *   Counters for profiling: the number of scope lists built with a vector
+     *   and table from the pool, and the number built with new ones.
+     */
+    hits = 0
+    misses = 0
+;
+
 /*  
  *   An object describing a reach problem; such objects are used by the Query
  *   object to communicate problems with one object touching another to the
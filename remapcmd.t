@@ -162,11 +162,44 @@ class RemapCmd: object
         doInsteadItems = [action,dobj,iobj,aobj];
     }
     
-    /* The strings that are the command(s) to match. For internal use only. */
-    cmdTerms = []   
+    /* 
+     *   Our position in the order in which RemapCmds were compiled, used to decide which of
+     *   several RemapCmds matching the same input takes precedence. For internal use only.
+     */
+    remapIdx_ = 0
+;
+
+/* 
+ *   A node in the network of words compiled from the cmd properties of all the RemapCmds in
+ *   the game. Each literal word in a cmd pattern gives rise to one node, so the network grows
+ *   with the size of the patterns rather than with the number of phrases they can match. For
+ *   internal use only.
+ */
+class RemapCmdNode: object
+    /* 
+     *   A LookupTable keyed on word, whose values are lists of the nodes reached by matching
+     *   that word from this node (nil until we have any).
+     */
+    edges = nil
     
-    /* The hash for these strings (faster compare later). For internal use only. */
-    cmdTermHash = []    
+    /* The list of RemapCmds matched if the input ends on this node (nil if none). */
+    accepts = nil
+    
+    /* Add a transition to node on matching word. */
+    addEdge(word, node)
+    {
+        if(edges == nil)
+            edges = new LookupTable(8, 16);
+        
+        local lst = edges[word];
+        edges[word] = (lst == nil ? [node] : lst + node);        
+    }
+    
+    /* Note that the input matches obj if it ends on this node. */
+    addAccept(obj)
+    {
+        accepts = (accepts == nil ? [obj] : accepts.appendUnique([obj]));
+    }
 ;
 
 /* ------------------------------------------------------------------------ */
@@ -179,25 +212,44 @@ class RemapCmd: object
  */
 
 remapCmdDicts: PreinitObject
-    /* Lookup table with hash and then list of objects that match it */
-    remapTbl = nil  
+    /* The root node of the network of words compiled from all the RemapCmd patterns */
+    root = nil
+    
+    /* The number of nodes in the network, for diagnostic purposes */
+    nodeCount = 0
     
-    /* The pre-init execution routine */
+    /* 
+     *   The pre-init execution routine. In a debug build, where preinit runs each time the game
+     *   starts, we leave compiling the RemapCmds until the first command is parsed.
+     */
     execute() {
-        remapTbl = new LookupTable(50,50);
-        local scmp = new StringComparator(nil,true,nil);    // case-sensitive as lower anyway
+#ifndef __DEBUG
+        compile();
+#endif
+    }
+    
+    /* Compile all the RemapCmds in the game into our network */
+    compile() {
+        root = new RemapCmdNode();
+        nodeCount = 1;
+        local idx = 0;
         
         for(local obj = firstObj(RemapCmd); obj != nil; obj = nextObj(obj,RemapCmd)) {
+            obj.remapIdx_ = ++idx;
+            
             // process the command
-            local res, toks;
-            local lst = [];
+            local toks;
             foreach(local str in obj.cmd.split(';')) {
                 try {
                     toks = remapCmdTokenizer.tokenize(str);
                     match = remapCmdGrammar.parseTokens(toks,nil);
                     if(match.length > 0) {
-                        res = match[1].lstval();
-                        lst = remapCmdGrammarOr(lst,res);
+                        // compile the phrase into the network, noting where it ends
+                        foreach(local node in match[1].compileTo([root])) {
+                            // an entirely empty phrase can never match anything
+                            if(node != root)
+                                node.addAccept(obj);
+                        }
                     } else
                         throw new EvalToksError(toks);
                 }
@@ -212,59 +264,91 @@ remapCmdDicts: PreinitObject
                     break;
                 }
             }
-            // have the parsed up items -- now join them up into individual possible commands
-            foreach(toks in lst) {
-                // always only allow ONE space between words
-                res = toks.join(' ').findReplace(R'<Space><Space>+',' ',ReplaceAll);
-                res = res.findReplace(R'(^<Space>+)|(<Space>+$)','',ReplaceAll);
-                obj.cmdTerms = obj.cmdTerms.append(res);
-                res = scmp.calcHash(res);
-                obj.cmdTermHash = obj.cmdTermHash.append(res);
-                addHashMap(res,obj);
-            }
         }
     }
     
-    /* add to the remapTbl for hash lookup */
-    addHashMap(hash,obj) {
-        if(remapTbl.isKeyPresent(hash)) {
-            remapTbl[hash] = remapTbl[hash].append(obj);
-        } else {
-            remapTbl[hash] = [obj];
+    /* 
+     *   Compile a single literal word following any of the nodes in the from list, returning
+     *   the list of nodes at which the word ends. An empty word (from "(|" or "|)") matches
+     *   nothing, so we just return the from list.
+     */
+    compileWord(from, word) {
+        if(word == '')
+            return from;
+        
+        local node = new RemapCmdNode();
+        ++nodeCount;
+        
+        foreach(local n in from)
+            n.addEdge(word, node);
+        
+        return [node];
+    }
+    
+    /* 
+     *   Advance the list of nodes we've reached so far over word, returning the list of nodes
+     *   reached after it.
+     */
+    advance(states, word) {
+        local nxt = [];
+        foreach(local n in states) {
+            if(n.edges == nil)
+                continue;
+            
+            local lst = n.edges[word];
+            if(lst != nil)
+                nxt = nxt.appendUnique(lst);
         }
+        return nxt;
     }
     
     /* process a tokenized string: return new string, obj if deferred, or nil if no match */
     processCmd(toks,tokcnt) {
-        local scmp = new StringComparator(nil,true,nil);    // everything is lower case
-        local acmd = '', ahash, obj, v;    // the string and its hash
+        /* make sure we've compiled our RemapCmds */
+        if(root == nil)
+            compile();
         
-        /* build the command */
+        local states = [root];
+        
+        /* only consider the tokens of the first command */
         if(tokcnt > 0)
             toks = toks.sublist(1,tokcnt);
-        acmd = toks.mapAll({x:x[1]});
-        acmd = acmd.join(' ');
-        ahash = scmp.calcHash(acmd);
         
-        if(!remapTbl.isKeyPresent(ahash))
-            return nil;
+        /* 
+         *   Walk the network one word at a time, giving up as soon as no node matches. A token
+         *   whose text contains spaces (such as a quoted string) counts as several words.
+         */
+        foreach(local tok in toks) {
+            local txt = tok[1];
+            foreach(local word in (txt.find(' ') == nil ? [txt] : txt.split(' '))) {
+                states = advance(states, word);
+                if(states.length() == 0)
+                    return nil;
+            }
+        }
+        
+        /* gather the RemapCmds matched by the whole input, in order of definition */
+        local cands = [];
+        foreach(local n in states) {
+            if(n.accepts != nil)
+                cands = cands.appendUnique(n.accepts);
+        }
+        
+        if(cands.length() > 1)
+            cands = cands.sort(SortAsc, {a, b: a.remapIdx_ - b.remapIdx_});
         
         /* scan the items that fit */
-        foreach(obj in remapTbl[ahash]) {
+        foreach(local obj in cands) {
             // support list of locations???
             if(obj.where != nil && valToList(obj.where).indexWhich({x:gLocation.isOrIsIn(x)}) == nil ) continue; // ECSE mod
             if(!obj.when) continue; // ECSE mod
             if(obj.during != nil && valToList(obj.during).indexWhich({s:s.isHappening}) == nil) continue; // ECSE mod
-            for(v = 1; v <= obj.cmdTermHash.length(); ++v) {
-                if(obj.cmdTermHash[v] == ahash && 
-                   scmp.matchValues(obj.cmdTerms[v],acmd) != 0) {
-                    // found it!
-                    obj.doInsteadItems = nil;  // clear it out before we move on
-                    if(obj.remappedCmd != nil)
-                        return obj.remappedCmd;
-                    return obj;
-                }
-            }
+            
+            // found it!
+            obj.doInsteadItems = nil;  // clear it out before we move on
+            if(obj.remappedCmd != nil)
+                return obj.remappedCmd;
+            return obj;
         }
         return nil;
     }
@@ -337,12 +421,20 @@ remapCmdTokenizer: Tokenizer
 //////////////////////////////////////////////////////////
 // Define the remapCmd grammar for the parser
 
-/* The most basic left level grammar map */
+/* 
+ *   The most basic left level grammar map. Besides lstval(), which expands a phrase into the
+ *   list of every word sequence it can match, each production defines compileTo(from), which
+ *   compiles the phrase into remapCmdDicts' network following any of the nodes in the from
+ *   list and returns the list of nodes at which the phrase can end.
+ */
 grammar remapCmdGrammar(lit): tokWord->txt_: Production
     lstval() {
         lst_ = [[txt_]];
         return lst_;
     }
+    compileTo(from) {
+        return remapCmdDicts.compileWord(from, txt_);
+    }
 ;
 
 /* handle concatenation of two words into the list
@@ -352,6 +444,9 @@ grammar remapCmdGrammar(concat): [badness 50]
     lstval() {
         return remapCmdGrammarConcat(pp_.lstval(),pp2_.lstval());
     }
+    compileTo(from) {
+        return pp2_.compileTo(pp_.compileTo(from));
+    }
 ;
 
 grammar remapCmdGrammar(or): [badness 30]
@@ -359,6 +454,9 @@ grammar remapCmdGrammar(or): [badness 30]
     lstval() {
         return remapCmdGrammarOr(pp_.lstval(),pp2_.lstval());
     }
+    compileTo(from) {
+        return pp_.compileTo(from).appendUnique(pp2_.compileTo(from));
+    }
 ;
 
 grammar remapCmdGrammar(tail): [badness 40]
@@ -367,6 +465,10 @@ grammar remapCmdGrammar(tail): [badness 40]
         local lst = remapCmdGrammarOr(pp2_.lstval(),pp3_.lstval());
         return remapCmdGrammarConcat(pp_.lstval(),lst);
     }
+    compileTo(from) {
+        local mid = pp_.compileTo(from);
+        return pp2_.compileTo(mid).appendUnique(pp3_.compileTo(mid));
+    }
 ;
 
 grammar remapCmdGrammar(grp): [badness 20]
@@ -374,6 +476,9 @@ grammar remapCmdGrammar(grp): [badness 20]
     lstval() {
         return pp_.lstval();
     }
+    compileTo(from) {
+        return pp_.compileTo(from);
+    }
 ;
 
 
@@ -695,8 +800,7 @@ modify Parser
                             topicPhrase, toks, cmdDict,
                             { p: new Command(SayAction, p) });
                         
-                        libGlobal.lastCommandForUndo = str;
-                        savepoint();
+                        undoManager.savepointFor(SayAction, str);
                     }
                     /* 
                      *   If the player char is not in conversation with anyone,
@@ -24,6 +24,11 @@ sceneManager: InitObject, Event
        
         eventManager.schedulableList += self;
         
+        /* Note all the Scenes in the game, so we needn't look for them each turn. */
+        sceneList = [];
+        for(local scene = firstObj(Scene); scene != nil ; scene = nextObj(scene, Scene))
+            sceneList += scene;
+        
         /* 
          *   Run the executeEvent() method for the first time to set up any
          *   scenes that should be active at the start of play.
@@ -46,6 +51,13 @@ sceneManager: InitObject, Event
      */
     maxLoopCount = 10
     
+    /* 
+     *   The list of all the Scenes in the game, built at initialization.
+     *   Scenes created dynamically after that add themselves to it when
+     *   they're constructed.
+     */
+    sceneList = []
+    
     /* The executeEvent() method is run each turn to drive the Scenes mechanism */
     executeEvent()
     {       
@@ -76,18 +88,18 @@ sceneManager: InitObject, Event
            
             
             /* Go through each Scene defined in the game in turn. */
-            for(local scene = firstObj(Scene); scene != nil ; scene = nextObj(scene,
-                Scene))            
+            foreach(local scene in sceneList)
             {     
                 
                 
                 /* 
                  *   If the scene's startsWhen condition is true and the scene is not already
                  *   happening, then provided it's a recurring scene or it's never been started
-                 *   before, start the scene.
+                 *   before, start the scene. We check the condition last so that we don't
+                 *   evaluate it (or record it as nil) when the scene couldn't start anyway.
                  */
-                if(scene.startsWhen && !scene.isHappening 
-                   && (scene.recurring || scene.startedAt == nil))
+                if(!scene.isHappening && (scene.recurring || scene.startedAt == nil)
+                   && scene.checkCondition(&startsWhen))
                 {
                     scene.start();
                     sceneStarted = true;
@@ -97,7 +109,8 @@ sceneManager: InitObject, Event
                  *   If the scene is happening and its endsWhen property is non-nil, then record the
                  *   value of its endsWhen property in its howEnded property and end the scene.
                  */
-                if(scene.isHappening && (scene.howEnded = scene.endsWhen) != nil)
+                if(scene.isHappening 
+                   && (scene.howEnded = scene.checkCondition(&endsWhen)) != nil)
                 {
                     scene.end();
                     sceneEnded = true;
@@ -130,21 +143,21 @@ sceneManager: InitObject, Event
     /* Run the beforeAction method on every currently active Scene */
     notifyBefore()
     {
-        forEachInstance(Scene, function(scene) 
+        foreach(local scene in sceneList)
         {
             if(scene.isHappening)
                 scene.beforeAction(); 
-        });
+        }
 }
 
 
 notifyAfter()
 {
-    forEachInstance(Scene, function(scene) 
+    foreach(local scene in sceneList)
     {
         if(scene.isHappening)
             scene.afterAction(); 
-    });
+    }
 }
 ;
 
@@ -152,9 +165,21 @@ notifyAfter()
 /* 
  *   A Scene is an object that represents a slice of time that starts and ends according to
  *   specified conditions, and which can define what happens when it starts and ends and also what
- *   happens each turn when it is happening.
+ *   happens each turn when it is happening. If a Scene defines conditionDeps (see
+ *   ReactiveCondition), its startsWhen and endsWhen conditions are only re-evaluated once
+ *   something they depend on has changed.
  */
-class Scene: object
+class Scene: ReactiveCondition
+    
+    /* 
+     *   When a Scene is created dynamically, add it to the sceneManager's list
+     *   so that it's polled each turn like any other.
+     */
+    construct()
+    {
+        inherited();
+        sceneManager.sceneList = sceneManager.sceneList.appendUnique([self]);
+    }
     
     /* 
      *   An expression or method that evaluates to true when you want the scene to start
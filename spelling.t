@@ -369,8 +369,22 @@ class CorrectionCandidate: object
  *   build, so that GrammarAltInfo is defined.  
  */
 actionDictionary: PreinitObject
-    /* initialize */
+    /* 
+     *   Initialize.  In a release build preinit runs at compile time, so we
+     *   build our tables straight away.  In a debug build preinit runs each
+     *   time the game starts, and the tables are only needed for spelling
+     *   correction, so we leave building them until they're first needed
+     *   (see getWordToAction() and getXwords()).
+     */
     execute()
+    {
+#ifndef __DEBUG
+        buildTables();
+#endif
+    }
+
+    /* build our tables */
+    buildTables()
     {
         /* get the table into a local for faster access */
         local atab = wordToAction = new LookupTable(128, 256);
@@ -426,6 +440,24 @@ actionDictionary: PreinitObject
      *   up', 'look up'.  
      */
     xwords = nil
+    
+    /* get the word-to-action table, building it if we haven't already */
+    getWordToAction()
+    {
+        if (wordToAction == nil)
+            buildTables();
+        
+        return wordToAction;
+    }
+    
+    /* get the associated word table, building it if we haven't already */
+    getXwords()
+    {
+        if (xwords == nil)
+            buildTables();
+        
+        return xwords;
+    }
 ;
 
 
@@ -444,6 +476,8 @@ actionDictionary: PreinitObject
 class SpellingHistory: object
     construct(parser)
     {
+        NoteAlloc(SpellingHistory);
+        
         /* remember the parser */
         self.parser = parser;
 
@@ -451,8 +485,15 @@ class SpellingHistory: object
         startTime = getTime(GetTimeTicks);
     }
 
-    /* have we made any corrections? */
-    hasCorrections() { return cstack.length() != 0; }
+    /* 
+     *   have we made any corrections?  (The parser asks this of every
+     *   command, so if we haven't created our stack yet we don't create it
+     *   just to find that it's empty.) 
+     */
+    hasCorrections()
+    {
+        return propDefined(&cstack, PropDefDirectly) && cstack.length() != 0;
+    }
 
     /*
      *   Check for spelling errors in a token list, and attempt automatic
@@ -29,6 +29,24 @@ class Mentionable: LMentionable
      *   The syntax is language-specific - see initVocab() for details.  
      */
     vocab = nil
+    
+    /* 
+     *   Initialize our vocabulary (the work is done in the language-specific
+     *   LMentionable), then let the vocabIndex know about our vocab string in
+     *   case it's changed.
+     */
+    initVocab()
+    {
+        inherited();
+        vocabIndex.noteVocab(self);
+    }
+    
+    /* 
+     *   The vocab string and key under which the vocabIndex has indexed us,
+     *   if it has. These are maintained by the vocabIndex.
+     */
+    vocabIndexVoc_ = nil
+    vocabIndexKey_ = nil
 
     /*
      *   The object's short name, for display in lists and announcements.
@@ -2149,7 +2167,7 @@ class Thing:  ReplaceRedirector, Mentionable
     isLit = nil
     
     /* Make this object lit or unlit */
-    makeLit(stat) { isLit = stat; }
+    makeLit(stat) { isLit = stat; libGlobal.exitsChanged(); }
     
     /* 
      *   Is this object visible in the dark without (necessarily) providing
@@ -2218,11 +2236,93 @@ class Thing:  ReplaceRedirector, Mentionable
     /*   Calculate the total bulk of the items contained within this object. */
     getBulkWithin()
     {
-        local totalBulk = 0;
-        foreach(local cur in contents)
-            totalBulk += cur.bulk;
+        checkAggregateStamp();
         
-        return totalBulk;
+        if(bulkWithinCache == nil)
+        {
+            local totalBulk = 0;
+            foreach(local cur in contents)
+                totalBulk += cur.bulk;
+            
+            bulkWithinCache = totalBulk;
+        }
+        
+        return bulkWithinCache;
+    }
+    
+    /* 
+     *   The number of objects directly or indirectly contained within us
+     *   (not counting the contents of any Rooms we contain). Unlike
+     *   allContents.length this doesn't build a list, so it's cheap to call
+     *   repeatedly.
+     */
+    descendantCount()
+    {
+        checkAggregateStamp();
+        
+        if(descendantCountCache == nil)
+        {
+            local count = contents.length;
+            foreach(local cur in contents)
+            {
+                if(!cur.ofKind(Room))
+                    count += cur.descendantCount();
+            }
+            
+            descendantCountCache = count;
+        }
+        
+        return descendantCountCache;
+    }
+    
+    /*  
+     *   Cached values of our containment aggregates (getBulkWithin,
+     *   descendantCount and, with the WEIGHT extension, getWeightWithin), or
+     *   nil if they need to be recalculated. These are only valid while
+     *   aggregateStamp matches the current turn, so that a bulk or weight
+     *   changed by direct assignment is picked up on the next turn at the
+     *   latest; code that changes the bulk or weight of something mid-turn
+     *   can call its location's invalidateAggregates() to have the change
+     *   noticed at once.
+     */
+    bulkWithinCache = nil
+    descendantCountCache = nil
+    aggregateStamp = nil
+    
+    /* 
+     *   If our cached aggregates date from an earlier turn (or have been
+     *   invalidated), discard them and start caching afresh for this turn.
+     */
+    checkAggregateStamp()
+    {
+        if(aggregateStamp != libGlobal.totalTurns)
+        {
+            clearAggregates();
+            aggregateStamp = libGlobal.totalTurns;
+        }
+    }
+    
+    /* Discard all our cached aggregate values. */
+    clearAggregates()
+    {
+        bulkWithinCache = nil;
+        descendantCountCache = nil;
+    }
+    
+    /* 
+     *   Note that our contents have changed, which invalidates our cached
+     *   aggregates and those of everything that contains us. We have to go
+     *   all the way up to the outermost container, since a container may have
+     *   cached an aggregate (such as getBulkWithin) without computing any
+     *   aggregates of its own contents, so an uncached container doesn't mean
+     *   that the ones outside it are uncached too.
+     */
+    invalidateAggregates()
+    {
+        aggregateStamp = nil;
+        
+        if(location != nil)
+            location.invalidateAggregates();
     }
     
     /*  
@@ -2431,6 +2531,7 @@ class Thing:  ReplaceRedirector, Mentionable
     discover(stat = true)
     {
         isHidden = !stat;
+        libGlobal.exitsChanged();
         
         /* 
          *   If the player character can see me when I'm hidden, note that the
@@ -2461,6 +2562,7 @@ class Thing:  ReplaceRedirector, Mentionable
     makeLocked(stat)
     {
         isLocked = stat;
+        libGlobal.exitsChanged();
     }
     
     /* 
@@ -2613,6 +2715,7 @@ class Thing:  ReplaceRedirector, Mentionable
     addToContents(obj, vec?)
     {
         contents = contents.appendUnique([obj]);
+        invalidateAggregates();
         if(vec != nil)
             vec.appendUnique(self);
     }
@@ -2628,7 +2731,10 @@ class Thing:  ReplaceRedirector, Mentionable
     {
         local idx = contents.indexOf(obj);
         if(idx != nil)
+        {
             contents = contents.removeElementAt(idx);
+            invalidateAggregates();
+        }
         
         if(vec != nil)
             vec.removeElement(self);
@@ -3280,18 +3386,25 @@ class Thing:  ReplaceRedirector, Mentionable
         parentFunc(cpar);
 
         /* 
-         *   Work back down from the common parent to other.  The easy way
-         *   to do this is to build a stack from other up to cpar, then
-         *   work back through the stack.  
+         *   Work back down from the common parent to other.  Rather than
+         *   building a stack of the containers from other up to cpar, we
+         *   let the call stack do the job, since this is done for nearly
+         *   every sense path we check.  
          */
-        local stk = new Vector(10);
-        for (local c = other.interiorParent() ; c != cpar ; 
-             c = c.interiorParent())
-            stk.push(c);
-        
-        /* work back through the stack */
-        while (!stk.isEmpty())
-            inFunc(stk.pop());
+        traceInwardPath(other.interiorParent(), cpar, inFunc);
+    }
+    
+    /* 
+     *   Call inFunc on each container from cpar (exclusive) down to c
+     *   (inclusive), outermost first.
+     */
+    traceInwardPath(c, cpar, inFunc)
+    {
+        if (c != cpar)
+        {
+            traceInwardPath(c.interiorParent(), cpar, inFunc);
+            inFunc(c);
+        }
     }
     
     /*
@@ -3309,22 +3422,32 @@ class Thing:  ReplaceRedirector, Mentionable
      *   we add that container to the blockage list.
      *   
      *   Finally, we return the blockage list.  This is a vector giving all
-     *   of the blockages we found, in the order we encountered them.  
+     *   of the blockages we found, in the order we encountered them, or an
+     *   empty list if we found none (which is usually the case, so we
+     *   don't create the vector until we find a blockage).  
      */
     containerPathBlock(other, inProp, outProp)
     {
-        /* set up a vector for the blockage list */
-        local vec = new Vector(10);
+        /* we don't have a blockage list yet */
+        local vec = nil;
+        
+        /* add a blockage to the list, creating the list if need be */
+        local block = new function(c) 
+        {
+            if (vec == nil)
+                vec = new Vector(4);
+            vec.append(c);
+        };
 
         /* trace the path, noting each blockage */
         traceContainerPath(
             other,
-            new function(c) { if (!c.(inProp)) vec.append(c); },
-            new function(c) { if (c == nil && outermostParent) vec.append(outermostParent()); },
-            new function(c) { if (!c.(outProp)) vec.append(c); });
+            new function(c) { if (!c.(inProp)) block(c); },
+            new function(c) { if (c == nil && outermostParent) block(outermostParent()); },
+            new function(c) { if (!c.(outProp)) block(c); });
 
         /* return the path */
-        return vec;
+        return vec ?? [];
     }
 
     /*
@@ -3565,18 +3688,43 @@ class Thing:  ReplaceRedirector, Mentionable
     {
         local vec = new Vector(20);
                
-        addToAllContents(vec, contents);
+        addToAllContents(vec, contents, new LookupTable(32, 64));
         
         return vec.toList;
     }
     
-    addToAllContents(vec, lst)
+    /* 
+     *   Add the items in lst, and recursively their contents, to vec. The
+     *   seen table records which items have already been added to vec (with
+     *   the value true) and which have also had their contents added (with
+     *   the value 2), so that each item is visited only once however many
+     *   times it turns up in the containment tree.
+     */
+    addToAllContents(vec, lst, seen?)
     {
-        vec.appendUnique(lst);
+        if(seen == nil)
+        {
+            seen = new LookupTable(32, 64);
+            foreach(local cur in vec)
+                seen[cur] = true;
+        }
+        
+        foreach(local cur in lst)
+        {
+            if(seen[cur] == nil)
+            {
+                seen[cur] = true;
+                vec.append(cur);
+            }
+        }
+        
         foreach(local cur in lst)
         {
-            if(!cur.ofKind(Room))
-                addToAllContents(vec, cur.contents);
+            if(!cur.ofKind(Room) && seen[cur] != 2)
+            {
+                seen[cur] = 2;
+                addToAllContents(vec, cur.contents, seen);
+            }
         }
     }
     
@@ -5156,6 +5304,7 @@ class Thing:  ReplaceRedirector, Mentionable
         isOpen = stat;
         if(stat)
             opened = true;
+        libGlobal.exitsChanged();
     }
     
     /* 
@@ -10275,6 +10424,18 @@ class MultiLoc: object
      */
     locationList = []
     
+    /* 
+     *   A change to our contents affects the aggregates of every location
+     *   we're in, not just our location.
+     */
+    invalidateAggregates()
+    {
+        inherited();
+        
+        foreach(local loc in locationList)
+            loc.invalidateAggregates();
+    }
+    
     
     /* 
      *   A list of the locations this object is to start out in. Locations may
@@ -449,11 +449,43 @@ class Room: TravelConnector, Thing
     
     /* 
      *   A Room can't be in another Room or a Thing, but it can notionally be in
-     *   a Region, so we check to see if we're in the list of our regions.
+     *   a Region, so we check to see if region is among the regions we're
+     *   directly or indirectly in.
      */    
     isIn(region)
     {
-        return valToList(regions).indexWhich({x: x.isOrIsIn(region)}) != nil;
+        return getRegionTab()[region] != nil;
+    }
+    
+    /* 
+     *   A LookupTable whose keys are all the regions this room is directly or
+     *   indirectly in, so that isIn() is a simple table lookup. This is built
+     *   from allRegions the first time it's needed, and must be discarded
+     *   (by calling resetRegions()) whenever our region membership changes.
+     */
+    regionTab = nil
+    
+    /* Get our regionTab, building it first if need be. */
+    getRegionTab()
+    {
+        if(regionTab == nil)
+        {
+            regionTab = new LookupTable(16, 32);
+            foreach(local reg in allRegions)
+                regionTab[reg] = true;
+        }
+        
+        return regionTab;
+    }
+    
+    /* 
+     *   Recalculate our region membership after the regions we're in have
+     *   changed.
+     */
+    resetRegions()
+    {
+        allRegions = getAllRegions();
+        regionTab = nil;
     }
     
     /* Add this room to the room list of all the regions it's in */    
@@ -489,7 +521,9 @@ class Room: TravelConnector, Thing
     /* return a list of regions that both this room and other are common to. */    
     regionsInCommonWith(other)
     {
-        return allRegions.subset({x: x.roomList.indexOf(other) != nil});        
+        local tab = other.getRegionTab();
+        
+        return allRegions.subset({x: tab[x] != nil});        
     }
     
     /* 
@@ -1396,13 +1430,13 @@ class DSDoor: DSCon, Door
      *   As we're a double-sided door, we only need to manage our own isOpen status; we don't need
      *   to refer to our other side.
      */
-    makeOpen(stat) { isOpen = stat; }
+    makeOpen(stat) { isOpen = stat; libGlobal.exitsChanged(); }
     
     /* 
      *   As we're a double-sided door, we only need to manage our own isOLocked status; we don't
      *   need to refer to our other side.
      */    
-    makeLocked(stat) { isLocked = stat; }
+    makeLocked(stat) { isLocked = stat; libGlobal.exitsChanged(); }
     
         
     /*   
@@ -2517,7 +2551,34 @@ class Region: object
      */    
     isIn(region)
     {               
-        return valToList(regions).indexWhich({x: x.isOrIsIn(region)}) != nil;
+        return getRegionTab()[region] != nil;
+    }
+    
+    /* 
+     *   A LookupTable whose keys are all the regions this Region is directly
+     *   or indirectly in, built from allRegions the first time it's needed.
+     */
+    regionTab = nil
+    
+    /* Get our regionTab, building it first if need be. */
+    getRegionTab()
+    {
+        if(regionTab == nil)
+        {
+            regionTab = new LookupTable(16, 32);
+            foreach(local reg in allRegions)
+                regionTab[reg] = true;
+        }
+        
+        return regionTab;
+    }
+    
+    /* 
+     *   Discard our regionTab, so that it's rebuilt next time it's needed.
+     */
+    resetRegions()
+    {
+        regionTab = nil;
     }
     
     /*  Is this Region either itself region or contained within in region */
@@ -2809,6 +2870,13 @@ regionPreinit: PreinitObject
         
         forEachInstance(Room, {r: r.addToRegions()} );
         
+        /* 
+         *   Make sure any region membership that was calculated before the
+         *   region lists were complete is calculated afresh.
+         */
+        forEachInstance(Region, {r: r.resetRegions()} );
+        forEachInstance(Room, {r: r.resetRegions()} );
+        
         forEachInstance(Region, { r: r.setFamiliarRooms() } );
     }
     